@@ -475,6 +475,20 @@ void Engine::setNullMove( bool nmv )
 	mainThread->search.enableNullMove( nmv );
 }
 
+// set lazy SMP iteration sync mode (old scheme)
+void Engine::setSmpIterSync( bool sync )
+{
+	abortSearch();
+	mainThread->search.setSmpIterSync( sync );
+}
+
+// share eval cache and pawn hash between threads
+void Engine::setSharedEvalCache( bool shared )
+{
+	abortSearch();
+	mainThread->search.setSharedEvalCache( shared );
+}
+
 // set elo limit master flag
 void Engine::setLimit( bool limit )
 {
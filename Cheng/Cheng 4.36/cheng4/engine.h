@@ -186,6 +186,12 @@ public:
 	// set nullmove flag
 	void setNullMove( bool nmv );
 
+	// set lazy SMP iteration sync mode (old scheme)
+	void setSmpIterSync( bool sync );
+
+	// share eval cache and pawn hash between threads
+	void setSharedEvalCache( bool shared );
+
 	// set elo limit master flag
 	void setLimit( bool limit );
 
@@ -337,8 +337,10 @@ void Eval::init()
 
 // Eval
 
-Eval::Eval() : occ(0), pe(0)
+Eval::Eval() : occ(0), pe(&pentry), ecache(&ownEcache), phash(&ownPhash), evalBytes(0), pawnBytes(0)
 {
+	memset( &pentry, 0, sizeof(pentry) );
+	stats.reset();
 	fscore[phOpening] = fscore[phEndgame] = 0;
 	safetyMask[ctWhite] = safetyMask[ctBlack] = 0;
 	attackers[ctWhite] = attackers[ctBlack] = 0;
@@ -347,12 +349,14 @@ Eval::Eval() : occ(0), pe(0)
 
 bool Eval::resizeEval( size_t sizeBytes )
 {
-	return ecache.resize( sizeBytes );
+	evalBytes = sizeBytes;
+	return ownEcache.resize( sizeBytes );
 }
 
 bool Eval::resizePawn( size_t sizeBytes )
 {
-	return phash.resize( sizeBytes );
+	pawnBytes = sizeBytes;
+	return ownPhash.resize( sizeBytes );
 }
 
 bool Eval::resizeMaterial( size_t sizeBytes )
@@ -363,11 +367,32 @@ bool Eval::resizeMaterial( size_t sizeBytes )
 // clear eval/pawn caches
 void Eval::clear()
 {
-	ecache.clear();
-	phash.clear();
+	ecache->clear();
+	phash->clear();
 	mhash.clear();
 }
 
+void Eval::setSharedCaches( Eval *master )
+{
+	if ( master && master != this )
+	{
+		ecache = &master->ownEcache;
+		phash = &master->ownPhash;
+		// free own caches while shared
+		ownEcache.resize( 0 );
+		ownPhash.resize( 0 );
+		return;
+	}
+	if ( ecache == &ownEcache )
+		return;
+	ecache = &ownEcache;
+	phash = &ownPhash;
+	ownEcache.resize( evalBytes );
+	ownPhash.resize( pawnBytes );
+	ownEcache.clear();
+	ownPhash.clear();
+}
+
 template< Color c > static inline bool isBareKing( const Board &b )
 {
 	return !(b.materialKey() & matMask[c] );
@@ -468,12 +493,19 @@ Score Eval::eval( const Board &b, Score alpha, Score beta )
 
 template< PopCountMode pcm > Score Eval::ieval( const Board &b, Score /*alpha*/, Score /*beta*/ )
 {
-	// probe eval cache first
-	EvalCacheEntry *ec = ecache.index( b.sig() );
-	if ( ec->sig == b.sig() )
-		return ec->score;					// hit => nothing to do
-	// probe pawn hash
-	pe = phash.index( b.pawnSig() );
+	// probe eval cache first (copy, then verify)
+	stats.cacheProbes++;
+	EvalCacheEntry *ec = ecache->index( b.sig() );
+	EvalCacheEntry lec = *ec;
+	if ( (lec.sig ^ lec.u.data) == b.sig() )
+	{
+		stats.cacheHits++;
+		return lec.u.s.score;				// hit => nothing to do
+	}
+	// probe pawn hash (copy, then verify)
+	stats.pawnProbes++;
+	PawnHashEntry *phe = phash->index( b.pawnSig() );
+	pentry = *phe;
 
 	// initialize fine scores for game phases
 	fscore[ phOpening ] = ScorePack::initFine( b.deltaMat( phOpening ) );
@@ -491,18 +523,20 @@ template< PopCountMode pcm > Score Eval::ieval( const Board &b, Score /*alpha*/,
 		safetyMask[c] = Tables::kingAttm[ b.king(c) ];
 	}
 
-	if ( pe->sig == b.pawnSig() )
+	if ( (pentry.sig ^ pentry.data()) == b.pawnSig() )
 	{
 		// pawn hash hit
+		stats.pawnHits++;
 		evalPawns< pcm, ctWhite, 0 >(b);
 		evalPawns< pcm, ctBlack, 0 >(b);
 	}
 	else
 	{
-		pe->sig = b.pawnSig();
-		pe->scores[ phOpening ] = pe->scores[ phEndgame ] = 0;
+		pentry.scores[ phOpening ] = pentry.scores[ phEndgame ] = 0;
 		evalPawns< pcm, ctWhite, 1 >(b);
 		evalPawns< pcm, ctBlack, 1 >(b);
+		pentry.sig = b.pawnSig() ^ pentry.data();
+		*phe = pentry;
 	}
 	// apply pawn hash scores
 	fscore[ phOpening ] += pe->scores[ phOpening ];
@@ -530,8 +564,10 @@ template< PopCountMode pcm > Score Eval::ieval( const Board &b, Score /*alpha*/,
 	res *= sign(b.turn());
 
 	// store to eval cache
-	ec->sig = b.sig();
-	ec->score = res;
+	lec.u.s.score = res;
+	lec.u.s.pad = 0;
+	lec.sig = b.sig() ^ lec.u.data;
+	*ec = lec;
 	return res;
 }
 
@@ -24,6 +24,8 @@ or as public domain (where applicable)
 #pragma once
 
 #include "board.h"
+#include "utils.h"
+#include <cstring>
 
 namespace cheng4
 {
@@ -103,21 +105,38 @@ private:
 };
 
 // size must be power of 2
+// sig is stored xor-ed with data so that entries can be shared between threads
 struct EvalCacheEntry
 {
 	Signature sig;			// signature
-	Score score;			// score
-	Score pad;				// pad to 16-byte struct
+	union u
+	{
+		struct s
+		{
+			Score score;	// score
+			Score pad;		// pad to 16-byte struct
+		} s;
+		u64 data;
+	} u;
 };
 
 typedef EvalHash<Signature, EvalCacheEntry> EvalCache;
 
 // size must be power of 2
+// sig is stored xor-ed with data so that entries can be shared between threads
 struct PawnHashEntry
 {
 	Signature sig;				// signature
 	Bitboard passers[phMax];	// passers for each color
 	FineScore scores[phMax];	// pawn scores for each game phase
+
+	// xor of data words
+	inline u64 data() const
+	{
+		u64 sc;
+		memcpy( &sc, scores, sizeof(sc) );
+		return passers[0] ^ passers[1] ^ sc;
+	}
 };
 
 typedef EvalHash<Signature, PawnHashEntry> PawnHash;
@@ -139,6 +158,27 @@ struct MaterialHashEntry
 
 typedef EvalHash<MaterialKey, MaterialHashEntry> MaterialHash;
 
+// eval cache/pawn hash statistics
+struct EvalStats
+{
+	NodeCount cacheProbes;
+	NodeCount cacheHits;
+	NodeCount pawnProbes;
+	NodeCount pawnHits;
+
+	inline void reset()
+	{
+		cacheProbes = cacheHits = pawnProbes = pawnHits = 0;
+	}
+	inline void add( const EvalStats &o )
+	{
+		cacheProbes += o.cacheProbes;
+		cacheHits += o.cacheHits;
+		pawnProbes += o.pawnProbes;
+		pawnHits += o.pawnHits;
+	}
+};
+
 struct Eval
 {
 	struct Recognizer
@@ -175,6 +215,12 @@ struct Eval
 	// clear eval/pawn/material caches
 	void clear();
 
+	// use eval cache and pawn hash of master (shared between threads)
+	// 0 = use own caches
+	void setSharedCaches( Eval *master );
+
+	EvalStats stats;			// cache statistics
+
 private:
 	// scores for game phases
 	FineScore fscore[phMax];
@@ -183,15 +229,21 @@ private:
 	Bitboard safetyMask[ctMax];	// safety masks for each king
 	u32 attackers[ctMax];		// attackers for each stm
 
-	PawnHashEntry *pe;			// pawn hash entry pointer
+	PawnHashEntry *pe;			// pawn hash entry pointer (points to local copy)
+	PawnHashEntry pentry;		// local copy of pawn hash entry
 
 	// attack mask [color][piece]
 	Bitboard attm[ctMax][ptMax];
 
-	EvalCache ecache;
-	PawnHash phash;
+	EvalCache ownEcache;
+	PawnHash ownPhash;
 	MaterialHash mhash;
 
+	EvalCache *ecache;			// eval cache in use (own or shared)
+	PawnHash *phash;			// pawn hash in use (own or shared)
+	size_t evalBytes;			// own eval cache size
+	size_t pawnBytes;			// own pawn hash size
+
 	template< PopCountMode pcm > Score ieval( const Board &b, Score alpha = -scInfinity, Score beta = +scInfinity );
 	
 	template< PopCountMode pcm, Color c, bool slow > void evalPawns( const Board &b );
@@ -281,6 +281,7 @@ u8 Magic::rookShr[64];
 u8 Magic::bishopShr[64];
 const Bitboard *Magic::rookPtr[64];
 const Bitboard *Magic::bishopPtr[64];
+bool Magic::pext = 0;
 
 const Bitboard Magic::rookMagic[64] = {
 	U64C(0x80001820804000),
@@ -484,7 +485,10 @@ u32 Magic::initMagicPtrs( Square sq, bool bishop )
 
 	// max 12 bits!
 	Bitboard *b = new Bitboard[ 4096 ];
-	Bitboard *a = new Bitboard[ (size_t)1u << n ];
+	// both backends use the same table size per square so we can rebuild in place
+	Bitboard *a = const_cast< Bitboard * >( bishop ? bishopPtr[sq] : rookPtr[sq] );
+	if ( !a )
+		a = new Bitboard[ (size_t)1u << n ];
 
 	memset( a, 0, ((size_t)1u << n) * sizeof(Bitboard) );
 
@@ -492,7 +496,10 @@ u32 Magic::initMagicPtrs( Square sq, bool bishop )
 		b[i] = indexToU64(i, n, mask);
 
 		i32 j;
-		if ( bishop )
+		if ( pext )
+			// indexToU64 deposits index bits into mask => pext gives back the index
+			j = (i32)BitOp::softPext( b[i], mask );
+		else if ( bishop )
 			j = (i32)((b[i] * bishopMagic[sq]) >> bishopShr[sq]);
 		else
 			j = (i32)((b[i] * rookMagic[sq]) >> rookShr[sq]);
@@ -549,9 +556,24 @@ void Magic::init()
 		bishopShr[ i ] = (u8)(64-BitOp::popCount(msk));
 	}
 
+	pext = BitOp::hasFastPext();
+
+	for (Square i=0; i<64; i++)
+		for (uint j=0; j<2; j++)
+			initMagicPtrs( i, j ? 1 : 0 );
+}
+
+bool Magic::setPext( bool enable )
+{
+	if ( enable && !BitOp::hasFastPext() )
+		return 0;
+	if ( enable == pext )
+		return 1;
+	pext = enable;
 	for (Square i=0; i<64; i++)
 		for (uint j=0; j<2; j++)
 			initMagicPtrs( i, j ? 1 : 0 );
+	return 1;
 }
 
 void Magic::done()
@@ -562,6 +584,7 @@ void Magic::done()
 			delete[] bishopPtr[i];
 		if ( rookPtr[i] )
 			delete[] rookPtr[i];
+		bishopPtr[i] = rookPtr[i] = 0;
 	}
 }
 
@@ -46,19 +46,39 @@ protected:
 	// rook/bishop magic multipliers
 	static const Bitboard rookMagic[64];
 	static const Bitboard bishopMagic[64];
+	// index attack tables using pext instead of magic multiply
+	static bool pext;
 public:
 	static void init();
 	static void done();
 
+	// switch slider attack backend (rebuilds attack tables in place)
+	// returns 0 if pext isn't supported
+	// not thread safe, must not be called while searching
+	static bool setPext( bool enable );
+
+	static inline bool usingPext()
+	{
+		return pext;
+	}
+
 	// occ: block mask
 	static inline Bitboard rookAttm( Square sq, Bitboard occ )
 	{
+#ifdef USE_PEXT
+		if ( pext )
+			return rookPtr[ sq ][ BitOp::pext( occ, rookRelOcc[ sq ] ) ];
+#endif
 		return rookPtr[ sq ][ (rookMagic[ sq ] * (occ & rookRelOcc[ sq ])) >> rookShr[ sq ] ];
 	}
 
 	// occ: block mask
 	static inline Bitboard bishopAttm( Square sq, Bitboard occ )
 	{
+#ifdef USE_PEXT
+		if ( pext )
+			return bishopPtr[ sq ][ BitOp::pext( occ, bishopRelOcc[ sq ] ) ];
+#endif
 		return bishopPtr[ sq ][ (bishopMagic[ sq ] * (occ & bishopRelOcc[ sq ])) >> bishopShr[ sq ] ];
 	}
 
@@ -37,6 +37,9 @@ or as public domain (where applicable)
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
 
 #ifdef IS_X64
 #	define maxHash "16384"
@@ -49,28 +52,125 @@ or as public domain (where applicable)
 namespace cheng4
 {
 
-static u64 pbook( std::ofstream &ofs, std::set< Signature > &procmap, Board &b, Search &s,
-	std::vector<Move> &line, Ply p, Depth d )
+// parallel book line generator
+
+// concurrent dedup set (sharded by signature)
+class SigSet
 {
-	u64 res = 0;
+	static const uint shards = 64;
+	Mutex locks[ shards ];
+	std::set< Signature > sets[ shards ];
+public:
+	// returns 1 if sig was newly inserted
+	bool insert( Signature sig )
+	{
+		uint i = (uint)(sig >> 58) & (shards-1);
+		MutexLock lock( locks[i] );
+		return sets[i].insert( sig ).second;
+	}
+	void erase( Signature sig )
+	{
+		uint i = (uint)(sig >> 58) & (shards-1);
+		MutexLock lock( locks[i] );
+		sets[i].erase( sig );
+	}
+	// not thread-safe (only used while paused)
+	void dump( std::ostream &os ) const
+	{
+		size_t count = 0;
+		for ( uint i=0; i<shards; i++ )
+			count += sets[i].size();
+		os << "processed " << count << std::endl;
+		for ( uint i=0; i<shards; i++ )
+		{
+			std::set< Signature >::const_iterator ci;
+			for ( ci = sets[i].begin(); ci != sets[i].end(); ci++ )
+				os << std::hex << *ci << std::dec << std::endl;
+		}
+	}
+};
+
+class PBookGen
+{
+public:
+	struct Node
+	{
+		std::vector< Move > line;
+		Ply ply;
+		Depth depth;
+	};
+
+	PBookGen() : pausing(0), active(0), finished(0), lines(0), positions(0)
+	{
+		tt.resize( 64*4096*1024 );	// 256 MB, shared by all searchers and kept between nodes
+	}
+
+	// run generator, resuming from checkpoint if requested
+	void run( uint threads, Depth depth, bool resume );
+
+	// worker main loop
+	void work();
+
+private:
+	static const char *outName;
+	static const char *checkpointName;
+	static const i32 checkpointInterval = 5*60*1000;	// msec
+
+	TransTable tt;
+	SigSet processed;
+	Mutex mutex;
+	std::vector< Node > queue;			// LIFO => depth-first, related nodes stay close in hash
+	std::ofstream ofs;
+	volatile bool pausing;
+	volatile uint active;
+	volatile uint finished;
+	u64 lines;
+	u64 positions;
+
+	void process( Search &s, const Node &n );
+	bool saveCheckpoint();
+	bool loadCheckpoint();
+};
+
+const char *PBookGen::outName = "booklines.txt";
+const char *PBookGen::checkpointName = "booklines.chk";
+
+class PBookWorker : public Thread
+{
+public:
+	PBookGen *gen;
+	void work()
+	{
+		gen->work();
+	}
+};
+
+void PBookGen::process( Search &s, const Node &n )
+{
+	Board b;
+	b.reset();
+	for ( size_t i=0; i<n.line.size(); i++ )
+	{
+		UndoInfo ui;
+		bool isCheck = b.isCheck( n.line[i], b.discovered() );
+		b.doMove( n.line[i], ui, isCheck );
+	}
+	if ( !processed.insert( b.sig() ) )
+		return;
 
-	std::set< Signature >::const_iterator ci = procmap.find(b.sig());
-	if ( ci != procmap.end() )
-		return res;
 	SearchMode sm;
 	sm.reset();
 	sm.maxDepth = 18;
-	sm.multiPV = 16 >> p;
+	sm.multiPV = 16 >> n.ply;
 	if ( sm.multiPV > 8 )
 		sm.multiPV = 8;
 	if ( sm.multiPV < 2 )
 		sm.multiPV = 2;
-	if ( d == 1 )
+	if ( n.depth == 1 )
 		sm.multiPV = 1;
-	s.clearHash();
+	// note: no clearHash here, sibling lines reuse the shared hashtable
 	s.clearSlots();
 	s.iterate(b, sm, 1);
-	procmap.insert( b.sig() );
 
 	std::vector< Move > moves;
 
@@ -81,103 +181,243 @@ static u64 pbook( std::ofstream &ofs, std::set< Signature > &procmap, Board &b,
 			continue;
 		moves.push_back( s.rootMoves.moves[i].move );
 	}
+
+	MutexLock lock( mutex );
+	positions++;
 	if ( moves.empty() )
-		return res;
+		return;
 
-	if ( d <= 0 )
+	if ( n.depth <= 0 )
 	{
 		// dump line
 		std::string l;
 		Board tb;
 		tb.reset();
-		for (size_t i=0; i<line.size(); i++)
+		for (size_t i=0; i<n.line.size(); i++)
 		{
-			l += tb.toSAN(line[i]);
+			l += tb.toSAN(n.line[i]);
 			l += ' ';
 			UndoInfo ui;
-			bool isCheck = tb.isCheck( line[i], tb.discovered() );
-			tb.doMove( line[i], ui, isCheck );
+			bool isCheck = tb.isCheck( n.line[i], tb.discovered() );
+			tb.doMove( n.line[i], ui, isCheck );
 		}
 		ofs << l << std::endl;
 		std::cout << '.';
-		return 1;
+		lines++;
+		return;
 	}
-	Bitboard dc = b.discovered();
-	Move m;
-	for ( size_t i=0; i<moves.size(); i++ )
-	{
-		m = moves[i];
-		UndoInfo ui;
-		bool isCheck = b.isCheck( m, dc );
-		b.doMove( m, ui, isCheck );
-		line.push_back( m );
 
-		res += pbook( ofs, procmap, b, s, line, p+1, d-1 );
-
-		line.pop_back();
-		b.undoMove( ui );
+	// push in reverse so that the best move is expanded first
+	for ( size_t i=moves.size(); i>0; i-- )
+	{
+		Node c;
+		c.line = n.line;
+		c.line.push_back( moves[i-1] );
+		c.ply = n.ply+1;
+		c.depth = n.depth-1;
+		queue.push_back( c );
 	}
-	return res;
 }
 
-static void pbook()
+void PBookGen::work()
 {
-	std::set< Signature > okmap;
-	TransTable tt;
 	Search *s = new Search;
-	tt.resize( 64*4096*1024 );	// 256 MB
 	s->setHashTable( &tt );
-	Board b;
-	b.reset();
-	std::ofstream ofs("booklines.txt");
-	std::vector< Move > line;
-	u64 res = pbook( ofs, okmap, b, *s, line, 0, 8 );
-	if ( !ofs )
+	for (;;)
 	{
-		std::cout << "can't write outfile" << std::endl;
+		Node n;
+		bool got = 0;
+		{
+			MutexLock lock( mutex );
+			if ( queue.empty() && !active )
+				break;
+			if ( !pausing && !queue.empty() )
+			{
+				n = queue.back();
+				queue.pop_back();
+				active++;
+				got = 1;
+			}
+		}
+		if ( !got )
+		{
+			Thread::sleep(1);
+			continue;
+		}
+		process( *s, n );
+		MutexLock lock( mutex );
+		active--;
 	}
-	std::cout << "positions: " << res << std::endl;
 	delete s;
+	MutexLock lock( mutex );
+	finished++;
 }
 
-static void runEPDSuite( const EPDFile &epd, Depth depth )
+// checkpoint: output size, counters, processed signatures and pending nodes (UCI moves)
+// only called while all workers are idle
+bool PBookGen::saveCheckpoint()
 {
-	TransTable tt;
-	Search *s = new Search;
-	tt.resize( 4096*1024 );
-	s->setHashTable( &tt );
-	size_t matching = 0;
-	size_t total = epd.positions.size();
-	for ( size_t i=0; i<total; i++ )
-	{
-		const EPDPosition &ep = epd.positions[i];
-		s->clearSlots();
-		s->clearHash();
+	ofs.flush();
+	std::string tmpName = std::string( checkpointName ) + ".tmp";
+	std::ofstream cs( tmpName.c_str() );
+	cs << "output " << (u64)ofs.tellp() << std::endl;
+	cs << "lines " << lines << std::endl;
+	cs << "positions " << positions << std::endl;
+	processed.dump( cs );
+	cs << "pending " << queue.size() << std::endl;
+	for ( size_t i=0; i<queue.size(); i++ )
+	{
+		const Node &n = queue[i];
+		cs << (int)n.ply << ' ' << (int)n.depth;
 		Board b;
-		if ( !b.fromFEN( ep.fen.c_str() ) )
-			continue;
-		SearchMode sm;
-		sm.reset();
-		sm.maxDepth = depth;
-		s->iterate( b, sm, 1 );
-		Move bm = s->iterBest;
-		size_t j;
-		for ( j=0; j<ep.avoid.size(); j++ )
-			if ( bm == ep.avoid[j] )
-				break;
-		if ( j < ep.avoid.size() )
-			continue;					// avoid_failed
-		for ( j=0; j<ep.best.size(); j++ )
-			if ( bm == ep.best[j] )
+		b.reset();
+		for ( size_t j=0; j<n.line.size(); j++ )
+		{
+			cs << ' ' << b.toUCI( n.line[j] );
+			UndoInfo ui;
+			bool isCheck = b.isCheck( n.line[j], b.discovered() );
+			b.doMove( n.line[j], ui, isCheck );
+		}
+		cs << std::endl;
+	}
+	cs.close();
+	if ( !cs )
+		return 0;
+	remove( checkpointName );
+	return rename( tmpName.c_str(), checkpointName ) == 0;
+}
+
+bool PBookGen::loadCheckpoint()
+{
+	std::ifstream cs( checkpointName );
+	if ( !cs )
+		return 0;
+	std::string tok;
+	size_t count;
+	u64 outSize;
+	cs >> tok >> outSize >> tok >> lines >> tok >> positions >> tok >> count;
+	for ( size_t i=0; i<count; i++ )
+	{
+		Signature sig;
+		cs >> std::hex >> sig >> std::dec;
+		processed.insert( sig );
+	}
+	cs >> tok >> count;
+	std::getline( cs, tok );
+	for ( size_t i=0; i<count && std::getline( cs, tok ); i++ )
+	{
+		std::stringstream ss( tok );
+		int ply, depth;
+		ss >> ply >> depth;
+		Node n;
+		n.ply = (Ply)ply;
+		n.depth = (Depth)depth;
+		Board b;
+		b.reset();
+		std::string mstr;
+		while ( ss >> mstr )
+		{
+			Move m = b.fromUCI( mstr );
+			if ( m == mcNone )
 				break;
-		if ( (!ep.avoid.empty() && ep.best.empty()) || j < ep.best.size() )
+			n.line.push_back( m );
+			UndoInfo ui;
+			bool isCheck = b.isCheck( m, b.discovered() );
+			b.doMove( m, ui, isCheck );
+		}
+		queue.push_back( n );
+	}
+	if ( cs.fail() && !cs.eof() )
+		return 0;
+
+	// drop lines written after the checkpoint, they will be generated again
+	std::string out;
+	{
+		std::ifstream is( outName, std::ios::in | std::ios::binary );
+		out.resize( (size_t)outSize );
+		if ( outSize && !is.read( &out[0], (std::streamsize)outSize ) )
+			return 0;
+	}
+	ofs.open( outName, std::ios::out | std::ios::binary | std::ios::trunc );
+	ofs.write( out.data(), (std::streamsize)out.size() );
+	return 1;
+}
+
+void PBookGen::run( uint threads, Depth depth, bool resume )
+{
+	if ( resume )
+	{
+		if ( !loadCheckpoint() )
 		{
-			// matching!
-			matching++;
+			std::cout << "can't load checkpoint" << std::endl;
+			return;
 		}
+		std::cout << "resuming: " << queue.size() << " pending nodes, " << lines << " lines" << std::endl;
 	}
-	std::cout << matching << " out of " << total << " positions passed" << std::endl;
-	delete s;
+	else
+	{
+		ofs.open( outName );
+		Node root;
+		root.ply = 0;
+		root.depth = depth;
+		queue.push_back( root );
+	}
+	if ( !ofs )
+	{
+		std::cout << "can't write outfile" << std::endl;
+		return;
+	}
+
+	i32 start = Timer::getMillisec();
+	i32 lastCheckpoint = start;
+	std::vector< PBookWorker * > workers;
+	for ( uint i=0; i<threads; i++ )
+	{
+		PBookWorker *w = new PBookWorker;
+		w->gen = this;
+		w->run();
+		workers.push_back( w );
+	}
+
+	while ( finished < threads )
+	{
+		Thread::sleep( 100 );
+		if ( Timer::getMillisec() - lastCheckpoint < checkpointInterval )
+			continue;
+		// pause workers and wait until in-flight nodes are done
+		pausing = 1;
+		for (;;)
+		{
+			{
+				MutexLock lock( mutex );
+				if ( !active )
+				{
+					if ( !saveCheckpoint() )
+						std::cout << "can't write checkpoint" << std::endl;
+					pausing = 0;
+					break;
+				}
+			}
+			Thread::sleep( 1 );
+		}
+		lastCheckpoint = Timer::getMillisec();
+	}
+	for ( size_t i=0; i<workers.size(); i++ )
+		workers[i]->kill();
+
+	// done => checkpoint no longer needed
+	remove( checkpointName );
+	i32 ms = Timer::getMillisec() - start;
+	std::cout << std::endl << "lines: " << lines << ", positions: " << positions << " ("
+		<< ms/1000 << " sec, " << threads << " threads)" << std::endl;
+}
+
+// pbook [threads [depth]] or pbook resume [threads]
+static void pbook( uint threads, Depth depth, bool resume )
+{
+	PBookGen *gen = new PBookGen;
+	gen->run( threads, depth, resume );
+	delete gen;
 }
 
 struct PerfTest
@@ -248,35 +488,78 @@ static const char *benchFens[] =
 	0
 };
 
-static void bench()
+static void printEvalStats( const EvalStats &st )
 {
-	NodeCount total = 0;
-	Search *s = new Search;
-	TransTable *tt = new TransTable;
-	tt->resize( 1*1048576 );
-	s->setHashTable(tt);
-	Board b;
-	SearchMode sm;
-	sm.reset();
-	sm.maxDepth = 13;
+	std::cout << "eval cache " << st.cacheHits << "/" << st.cacheProbes << " ("
+		<< std::fixed << std::setprecision(1) << 100.0*(double)st.cacheHits/(double)(st.cacheProbes ? st.cacheProbes : 1)
+		<< "%), pawn hash " << st.pawnHits << "/" << st.pawnProbes << " ("
+		<< 100.0*(double)st.pawnHits/(double)(st.pawnProbes ? st.pawnProbes : 1) << "%)";
+}
 
-	const char **p = benchFens;
+// lazy SMP benchmark: time to fixed depth over bench positions
+// for both iteration schemes, private/shared eval caches and increasing thread counts
+static void smpBench( Depth depth, const std::vector< uint > &threads )
+{
+	static const char *names[3] =
+	{
+		"independent helper iterations, private eval caches:",
+		"independent helper iterations, shared eval caches:",
+		"synchronized iterations (old scheme), private eval caches:"
+	};
+	for ( int config = 0; config < 3; config++ )
+	{
+		int sync = config == 2;
+		std::cout << names[config] << std::endl;
+		i32 baseTicks = 0;
+		for ( size_t i=0; i<threads.size(); i++ )
+		{
+			// fresh search and hashtable for each run
+			Search *s = new Search;
+			TransTable *tt = new TransTable;
+			tt->resize( 16*1048576 );
+			s->setHashTable( tt );
+			s->setSmpIterSync( sync != 0 );
+			s->setThreads( threads[i]-1 );
+			s->setSharedEvalCache( config == 1 );
 
-	i32 ticks = Timer::getMillisec();
-	while ( *p )
-	{
-		s->clearHash();
-		s->clearSlots();
-		b.fromFEN( *p++ );
-		s->iterate(b, sm, 1 );
-		total += s->nodes;
+			Board b;
+			SearchMode sm;
+			sm.reset();
+			sm.maxDepth = depth;
+
+			NodeCount total = 0;
+			EvalStats evalStats;
+			evalStats.reset();
+			const char **p = benchFens;
+
+			i32 ticks = Timer::getMillisec();
+			while ( *p )
+			{
+				s->clearHash();
+				s->clearSlots();
+				b.fromFEN( *p++ );
+				s->iterate( b, sm, 1 );
+				total += s->smpNodes();
+				EvalStats st;
+				s->getEvalStats( st );
+				evalStats.add( st );
+			}
+			ticks = Timer::getMillisec() - ticks;
+			if ( !i )
+				baseTicks = ticks;
+
+			// helpers must go before the hashtable
+			delete s;
+			delete tt;
+
+			std::cout << "threads " << threads[i] << ": " << ticks << " msec to depth " << (int)depth
+					  << ", " << total << " nodes (" << total*1000/(ticks ? ticks : 1) << " nps), speedup "
+					  << std::fixed << std::setprecision(2) << (double)baseTicks / (double)(ticks ? ticks : 1)
+					  << ", ";
+			printEvalStats( evalStats );
+			std::cout << std::endl;
+		}
 	}
-	ticks = Timer::getMillisec() - ticks;
-	delete tt;
-	delete s;
-	std::cout << total << " nodes in "
-			  << ticks << " msec (" << std::fixed
-			  << total*1000/(ticks ? ticks : 1) << " nps)" << std::endl;
 }
 
 static NodeCount perft( cheng4::Board &b, Depth depth )
@@ -310,45 +593,342 @@ static NodeCount perft( cheng4::Board &b, Depth depth )
 	return res;
 }
 
-static bool pbench()
+static volatile Bitboard magicBenchSink;
+
+// slider attack/movegen micro-benchmark: magic multiply vs pext indexing
+static void magicBench( Depth depth )
+{
+	bool oldPext = Magic::usingPext();
+	NodeCount refNodes = 0;
+
+	for ( int backend = 0; backend < 2; backend++ )
+	{
+		if ( !Magic::setPext( backend != 0 ) )
+		{
+			std::cout << "pext: not available on this cpu" << std::endl;
+			break;
+		}
+		std::cout << (backend ? "pext:  " : "magic: ");
+
+		// raw lookups over bench position occupancies
+		Board b;
+		Bitboard occ[ 16 ];
+		uint nocc = 0;
+		for ( const char **p = benchFens; *p && nocc < 16; p++ )
+		{
+			b.fromFEN( *p );
+			occ[ nocc++ ] = b.occupied();
+		}
+		const uint iterations = 100000;
+		Bitboard acc = 0;
+		i32 ticks = Timer::getMillisec();
+		for ( uint i=0; i<iterations; i++ )
+			for ( uint j=0; j<nocc; j++ )
+			{
+				Bitboard o = occ[j] ^ acc;
+				for ( Square sq = 0; sq < 64; sq++ )
+					acc ^= Magic::rookAttm( sq, o ) ^ Magic::bishopAttm( sq, o );
+			}
+		ticks = Timer::getMillisec() - ticks;
+		u64 lookups = (u64)iterations * nocc * 64 * 2;
+		std::cout << lookups / 1000 / (ticks ? ticks : 1) << " Mlookups/s";
+
+		// movegen (perft)
+		NodeCount nodes = 0;
+		ticks = Timer::getMillisec();
+		for ( const char **p = benchFens; *p; p++ )
+		{
+			b.fromFEN( *p );
+			nodes += perft( b, depth );
+		}
+		ticks = Timer::getMillisec() - ticks;
+		std::cout << ", perft " << (int)depth << ": " << nodes << " nodes, " << ticks << " msec ("
+				  << nodes / 1000 / (ticks ? ticks : 1) << " Mnps)";
+		if ( backend && nodes != refNodes )
+			std::cout << " MISMATCH!";
+		refNodes = nodes;
+		std::cout << std::endl;
+		// keep lookups alive
+		magicBenchSink = acc;
+	}
+	Magic::setPext( oldPext );
+	std::cout << "using " << (Magic::usingPext() ? "pext" : "magic") << std::endl;
+}
+
+// concurrent suite runner (bench, pbench, runepd)
+
+enum ReportFormat
+{
+	rfText,
+	rfCSV,
+	rfJSON
+};
+
+static ReportFormat parseFormat( const std::string &str )
+{
+	if ( str == "csv" )
+		return rfCSV;
+	if ( str == "json" )
+		return rfJSON;
+	return rfText;
+}
+
+struct SuiteJob
+{
+	std::string fen;
+	Depth depth;
+	bool perft;					// run perft instead of search
+	NodeCount expected;			// expected perft count
+	const EPDPosition *epd;		// epd position to check solution (or 0)
+};
+
+struct SuiteReport
 {
-	uint count = 0;
-	for (const PerfTest *pt = suite; pt->fen; pt++ )
-		count++;
+	NodeCount nodes;
+	i32 ms;
+	Depth depth;
+	int solved;					// 1 = solved/passed, 0 = failed, -1 = n/a
+	std::string move;			// best move (SAN)
+};
 
-	i32 totticks = Timer::getMillisec();
+static bool epdSolved( const EPDPosition &ep, Move bm )
+{
+	size_t j;
+	for ( j=0; j<ep.avoid.size(); j++ )
+		if ( bm == ep.avoid[j] )
+			return 0;			// avoid_failed
+	for ( j=0; j<ep.best.size(); j++ )
+		if ( bm == ep.best[j] )
+			break;
+	return (!ep.avoid.empty() && ep.best.empty()) || j < ep.best.size();
+}
 
-	uint index = 0;
-	uint fails = 0;
-	for (const PerfTest *pt = suite; pt->fen; pt++, index++ )
+class SuiteWorker : public Thread
+{
+public:
+	const std::vector< SuiteJob > *jobs;
+	std::vector< SuiteReport > *reports;
+	Mutex *mutex;
+	size_t *next;
+	size_t ttBytes;
+
+	void work();
+};
+
+void SuiteWorker::work()
+{
+	// each worker has its own search and hashtable slice (allocated on first search)
+	Search *s = 0;
+	TransTable *tt = 0;
+	for (;;)
 	{
-		std::cout << "position " << 1+index << "/" << count << " : " << pt->fen << std::endl;
+		size_t i;
+		{
+			MutexLock lock( *mutex );
+			i = (*next)++;
+		}
+		if ( i >= jobs->size() )
+			break;
+		const SuiteJob &job = (*jobs)[i];
+		SuiteReport &rep = (*reports)[i];
+		rep.nodes = 0;
+		rep.ms = 0;
+		rep.depth = job.depth;
+		rep.solved = -1;
 
-		cheng4::Board b;
-		if ( !b.fromFEN( pt->fen ) )
+		Board b;
+		if ( !b.fromFEN( job.fen.c_str() ) )
 		{
-			std::cout << "ILLEGAL FEN!" << std::endl;
-			return 0;
+			rep.solved = 0;
+			continue;
 		}
 
-		NodeCount result;
 		i32 ticks = Timer::getMillisec();
-		std::cout << "perft(" << (int)pt->depth << ") = " << (result = perft( b, pt->depth )) << std::endl;
-		ticks = Timer::getMillisec() - ticks;
-		std::cout << "took " << (double)ticks / 1000.0 << " sec, " << (double)result / 1000.0 / (double)ticks << " Mnps" << std::endl;
+		if ( job.perft )
+		{
+			rep.nodes = perft( b, job.depth );
+			rep.solved = rep.nodes == job.expected;
+		}
+		else
+		{
+			if ( !s )
+			{
+				s = new Search;
+				tt = new TransTable;
+				tt->resize( ttBytes );
+				s->setHashTable( tt );
+			}
+			s->clearHash();
+			s->clearSlots();
+			SearchMode sm;
+			sm.reset();
+			sm.maxDepth = job.depth;
+			s->iterate( b, sm, 1 );
+			rep.nodes = s->nodes;
+			if ( s->iterBest != mcNone )
+				rep.move = b.toSAN( s->iterBest );
+			if ( job.epd )
+				rep.solved = epdSolved( *job.epd, s->iterBest );
+		}
+		rep.ms = Timer::getMillisec() - ticks;
+	}
+	delete s;
+	delete tt;
+}
 
-		if ( result != pt->count )
-			fails++;
+// run jobs on threads, returns wall time in ms
+static i32 runSuite( const std::vector< SuiteJob > &jobs, std::vector< SuiteReport > &reports,
+	uint threads, size_t ttBytes )
+{
+	reports.resize( jobs.size() );
+	Mutex mutex;
+	size_t next = 0;
+	threads = (uint)std::max( (size_t)1, std::min( (size_t)threads, jobs.size() ) );
+
+	i32 ticks = Timer::getMillisec();
+	std::vector< SuiteWorker * > workers;
+	for ( uint i=0; i<threads; i++ )
+	{
+		SuiteWorker *w = new SuiteWorker;
+		w->jobs = &jobs;
+		w->reports = &reports;
+		w->mutex = &mutex;
+		w->next = &next;
+		w->ttBytes = ttBytes;
+		w->run();
+		workers.push_back( w );
+	}
+	for ( size_t i=0; i<workers.size(); i++ )
+		workers[i]->kill();
+	return Timer::getMillisec() - ticks;
+}
 
-		std::cout << ((result == pt->count) ? "passed" : "FAILED!") << std::endl;
+// print per-position reports and totals
+// returns number of failed positions
+static size_t printReports( const std::vector< SuiteJob > &jobs, const std::vector< SuiteReport > &reports,
+	ReportFormat format, uint threads, i32 ticks )
+{
+	NodeCount total = 0;
+	size_t solved = 0, failed = 0;
+	for ( size_t i=0; i<reports.size(); i++ )
+	{
+		total += reports[i].nodes;
+		solved += reports[i].solved > 0;
+		failed += reports[i].solved == 0;
 	}
-	totticks = Timer::getMillisec() - totticks;
-	std::cout << "total " << (double)totticks / 1000.0 << " sec" << std::endl;
+
+	if ( format == rfCSV )
+		std::cout << "index,fen,depth,nodes,ms,nps,move,solved" << std::endl;
+	else if ( format == rfJSON )
+		std::cout << "{\"threads\":" << threads << ",\"positions\":[" << std::endl;
+
+	for ( size_t i=0; i<reports.size(); i++ )
+	{
+		const SuiteJob &job = jobs[i];
+		const SuiteReport &rep = reports[i];
+		NodeCount nps = rep.nodes*1000/(rep.ms ? rep.ms : 1);
+		const char *state = rep.solved < 0 ? "" : rep.solved ? "1" : "0";
+		switch( format )
+		{
+		case rfCSV:
+			std::cout << i+1 << ',' << job.fen << ',' << (int)rep.depth << ',' << rep.nodes << ','
+				<< rep.ms << ',' << nps << ',' << rep.move << ',' << state << std::endl;
+			break;
+		case rfJSON:
+			std::cout << "{\"index\":" << i+1 << ",\"fen\":\"" << job.fen << "\",\"depth\":" << (int)rep.depth
+				<< ",\"nodes\":" << rep.nodes << ",\"ms\":" << rep.ms << ",\"nps\":" << nps
+				<< ",\"move\":\"" << rep.move << "\",\"solved\":"
+				<< (rep.solved < 0 ? "null" : rep.solved ? "true" : "false")
+				<< (i+1 < reports.size() ? "}," : "}") << std::endl;
+			break;
+		default:
+			std::cout << "position " << i+1 << "/" << reports.size() << " : " << job.fen << std::endl;
+			std::cout << "depth " << (int)rep.depth << ", " << rep.nodes << " nodes, " << rep.ms << " msec ("
+				<< nps << " nps)";
+			if ( !rep.move.empty() )
+				std::cout << ", best " << rep.move;
+			if ( rep.solved >= 0 )
+				std::cout << (rep.solved ? ", passed" : ", FAILED!");
+			std::cout << std::endl;
+		}
+	}
+
+	if ( format == rfJSON )
+		std::cout << "],\"nodes\":" << total << ",\"ms\":" << ticks << ",\"nps\":"
+			<< total*1000/(ticks ? ticks : 1) << ",\"solved\":" << solved << ",\"failed\":" << failed
+			<< "}" << std::endl;
+	else if ( format == rfText )
+		std::cout << total << " nodes in " << ticks << " msec (" << total*1000/(ticks ? ticks : 1)
+			<< " nps, " << threads << " threads)" << std::endl;
+	std::cout.flush();
+	return failed;
+}
+
+static void runEPDSuite( const EPDFile &epd, Depth depth, uint threads, ReportFormat format )
+{
+	std::vector< SuiteJob > jobs;
+	for ( size_t i=0; i<epd.positions.size(); i++ )
+	{
+		SuiteJob job;
+		job.fen = epd.positions[i].fen;
+		job.depth = depth;
+		job.perft = 0;
+		job.expected = 0;
+		job.epd = &epd.positions[i];
+		jobs.push_back( job );
+	}
+	std::vector< SuiteReport > reports;
+	i32 ticks = runSuite( jobs, reports, threads, 4096*1024 );
+	printReports( jobs, reports, format, threads, ticks );
+	if ( format != rfText )
+		return;
+	size_t matching = 0;
+	for ( size_t i=0; i<reports.size(); i++ )
+		matching += reports[i].solved > 0;
+	std::cout << matching << " out of " << jobs.size() << " positions passed" << std::endl;
+}
+
+static void bench( uint threads, ReportFormat format )
+{
+	std::vector< SuiteJob > jobs;
+	for ( const char **p = benchFens; *p; p++ )
+	{
+		SuiteJob job;
+		job.fen = *p;
+		job.depth = 13;
+		job.perft = 0;
+		job.expected = 0;
+		job.epd = 0;
+		jobs.push_back( job );
+	}
+	std::vector< SuiteReport > reports;
+	i32 ticks = runSuite( jobs, reports, threads, 1*1048576 );
+	printReports( jobs, reports, format, threads, ticks );
+}
+
+static bool pbench( uint threads, ReportFormat format )
+{
+	std::vector< SuiteJob > jobs;
+	for ( const PerfTest *pt = suite; pt->fen; pt++ )
+	{
+		SuiteJob job;
+		job.fen = pt->fen;
+		job.depth = pt->depth;
+		job.perft = 1;
+		job.expected = pt->count;
+		job.epd = 0;
+		jobs.push_back( job );
+	}
+	std::vector< SuiteReport > reports;
+	i32 ticks = runSuite( jobs, reports, threads, 0 );
+	size_t fails = printReports( jobs, reports, format, threads, ticks );
+	if ( format != rfText )
+		return !fails;
 	if ( fails )
-		std::cout << fails << " / " << count << " FAILED!" << std::endl;
+		std::cout << fails << " / " << jobs.size() << " FAILED!" << std::endl;
 	else
 		std::cout << "ALL OK" << std::endl;
-  return !fails;
+	return !fails;
 }
 
 // Protocol
@@ -1041,6 +1621,8 @@ bool Protocol::parseUCI( const std::string &line )
 		sendRaw( "option name UCI_LimitStrength type check default false" ); sendEOL();
 		sendRaw( "option name UCI_Elo type spin min 800 max 2500 default 2500" ); sendEOL();
 		sendRaw( "option name NullMove type check default true" ); sendEOL();
+		sendRaw( "option name LazySMPSync type check default false" ); sendEOL();
+		sendRaw( "option name SharedEvalCache type check default false" ); sendEOL();
 #ifdef USE_TUNING
 		for ( size_t i=0; i<TunableParams::paramCount(); i++ )
 		{
@@ -1156,6 +1738,16 @@ bool Protocol::parseUCIOptions( const std::string &line, size_t &pos )
 		engine.setNullMove( value != "false" );
 		return 1;
 	}
+	if ( key == "LazySMPSync")
+	{
+		engine.setSmpIterSync( value == "true" );
+		return 1;
+	}
+	if ( key == "SharedEvalCache")
+	{
+		engine.setSharedEvalCache( value == "true" );
+		return 1;
+	}
 #ifdef USE_TUNING
 	if ( TunableParams::setParam(key.c_str(), value.c_str()) )
 		return 1;
@@ -1557,7 +2149,7 @@ bool Protocol::parseCECPInternal( const std::string &line )
 			"nps=1 smp=1 debug=0 draw=0 playother=1 variants=\"normal,fischerandom\" ics=0 memory=1 ping=0 "
 			"option=\"Clear Hash -button\" option=\"Hash -spin 4 1 " maxHash "\" option=\"Threads -spin 1 1 64\" "
 			"option=\"OwnBook -check 1\" option=\"LimitStrength -check 0\" option=\"Elo -spin 2500 800 2500\" "
-			"option=\"MultiPV -spin 1 1 256\" option=\"NullMove -check 1\" myname=\""
+			"option=\"MultiPV -spin 1 1 256\" option=\"NullMove -check 1\" option=\"LazySMPSync -check 0\" option=\"SharedEvalCache -check 0\" myname=\""
 		);
 		sendRaw( Version::version() );
 		sendRaw( "\" "
@@ -1673,6 +2265,18 @@ bool Protocol::parseCECPInternal( const std::string &line )
 			engine.setNullMove( nm != 0 );
 			return 1;
 		}
+		if ( token == "LazySMPSync" )
+		{
+			long sync = strtol( line.c_str() + pos, 0, 10 );
+			engine.setSmpIterSync( sync != 0 );
+			return 1;
+		}
+		if ( token == "SharedEvalCache" )
+		{
+			long shared = strtol( line.c_str() + pos, 0, 10 );
+			engine.setSharedEvalCache( shared != 0 );
+			return 1;
+		}
 		if ( token == "LimitStrength" )
 		{
 			long lst = strtol( line.c_str() + pos, 0, 10 );
@@ -1979,14 +2583,56 @@ bool Protocol::parseSpecial( const std::string &token, const std::string &line,
 	}
 	if ( token == "bench" )
 	{
+		// bench [threads [csv|json]]
 		engine.abortSearch();
-		bench();
+		std::string t = nextToken( line, pos );
+		uint threads = t.empty() ? 1 : (uint)std::max( 1l, strtol( t.c_str(), 0, 10 ) );
+		bench( threads, parseFormat( nextToken( line, pos ) ) );
+		return 1;
+	}
+	if ( token == "evalstats" )
+	{
+		// eval cache statistics of last search
+		EvalStats st;
+		engine.mainThread->search.getEvalStats( st );
+		printEvalStats( st );
+		std::cout << std::endl;
+		return 1;
+	}
+	if ( token == "smpbench" )
+	{
+		// smpbench [depth [threads...]]
+		engine.abortSearch();
+		std::string t = nextToken( line, pos );
+		long tmp = t.empty() ? 12 : strtol( t.c_str(), 0, 10 );
+		Depth d = (Depth)( std::max( 1l, std::min( (long)maxDepth, tmp ) ) );
+		std::vector< uint > threads;
+		while ( !(t = nextToken( line, pos )).empty() )
+			threads.push_back( (uint)std::max( 1l, std::min( 64l, strtol( t.c_str(), 0, 10 ) ) ) );
+		if ( threads.empty() )
+		{
+			static const uint defThreads[] = { 1, 4, 8, 16, 32 };
+			threads.assign( defThreads, defThreads + sizeof(defThreads)/sizeof(defThreads[0]) );
+		}
+		smpBench( d, threads );
 		return 1;
 	}
 	if ( token == "pbench" )
 	{
+		// pbench [threads [csv|json]]
 		engine.abortSearch();
-		pbench();
+		std::string t = nextToken( line, pos );
+		uint threads = t.empty() ? 1 : (uint)std::max( 1l, strtol( t.c_str(), 0, 10 ) );
+		pbench( threads, parseFormat( nextToken( line, pos ) ) );
+		return 1;
+	}
+	if ( token == "magicbench" )
+	{
+		// magicbench [perft_depth]
+		engine.abortSearch();
+		std::string t = nextToken( line, pos );
+		long tmp = t.empty() ? 4 : strtol( t.c_str(), 0, 10 );
+		magicBench( (Depth)( std::max( 1l, std::min( (long)maxDepth, tmp ) ) ) );
 		return 1;
 	}
 	if ( token == "perft" )
@@ -2084,13 +2730,29 @@ bool Protocol::parseSpecial( const std::string &token, const std::string &line,
 	}
 	if ( token == "runepd" )
 	{
-		// epd debug run
-		runEPDSuite( epd, 2 );
+		// epd debug run: runepd [depth [threads [csv|json]]]
+		engine.abortSearch();
+		std::string t = nextToken( line, pos );
+		long tmp = t.empty() ? 2 : strtol( t.c_str(), 0, 10 );
+		Depth d = (Depth)( std::max( 1l, std::min( (long)maxDepth, tmp ) ) );
+		t = nextToken( line, pos );
+		uint threads = t.empty() ? 1 : (uint)std::max( 1l, strtol( t.c_str(), 0, 10 ) );
+		runEPDSuite( epd, d, threads, parseFormat( nextToken( line, pos ) ) );
 		return 1;
 	}
 	if ( token == "pbook" )
 	{
-		pbook();
+		// pbook [threads [depth]] or pbook resume [threads]
+		engine.abortSearch();
+		std::string t = nextToken( line, pos );
+		bool resume = t == "resume";
+		if ( resume )
+			t = nextToken( line, pos );
+		uint threads = t.empty() ? 1 : (uint)std::max( 1l, strtol( t.c_str(), 0, 10 ) );
+		t = nextToken( line, pos );
+		long tmp = t.empty() ? 8 : strtol( t.c_str(), 0, 10 );
+		Depth d = (Depth)( std::max( 0l, std::min( (long)maxDepth, tmp ) ) );
+		pbook( threads, d, resume );
 		return 1;
 	}
 #ifdef USE_TUNING
@@ -2100,6 +2762,26 @@ bool Protocol::parseSpecial( const std::string &token, const std::string &line,
 		std::cout.flush();
 		return 1;
 	}
+	if ( token == "texel" )
+	{
+		// texel <file> [threads [passes]]
+		engine.abortSearch();
+		std::string fnm = nextToken( line, pos );
+		std::string t = nextToken( line, pos );
+		uint threads = t.empty() ? 1 : (uint)std::max( 1l, strtol( t.c_str(), 0, 10 ) );
+		t = nextToken( line, pos );
+		uint passes = t.empty() ? 100 : (uint)std::max( 1l, strtol( t.c_str(), 0, 10 ) );
+		TexelTuner tuner;
+		i32 ms = Timer::getMillisec();
+		if ( !tuner.load( fnm.c_str() ) )
+		{
+			error( "no positions loaded", line );
+			return 1;
+		}
+		std::cout << "loading took " << Timer::getMillisec() - ms << " ms" << std::endl;
+		tuner.tune( threads, passes );
+		return 1;
+	}
 #endif
 	return 0;
 }
@@ -542,7 +542,7 @@ skipNull:
 Search::Search( size_t evalKilo, size_t pawnKilo, size_t matKilo ) : startTicks(0), nodeTicks(0),
 	timeOutCounter(0), triPV(0), newMultiPV(0), selDepth(0), tt(0), nodes(0), age(0), callback(0),
 	callbackParam(0), canStop(0), abortRequest(0), aborting(0), abortingSmp(0),
-	outputBest(1), ponderHit(0), maxThreads(63), eloLimit(0), maxElo(2500), 
+	outputBest(1), ponderHit(0), maxThreads(63), smpIterSync(0), sharedEval(0), eloLimit(0), maxElo(2500), 
 	minQsDepth(-maxDepth), verbose(1), searchFlags(0), startSearch(0), master(0)
 {
 	board.reset();
@@ -803,7 +803,7 @@ Score Search::root( Depth depth, Score alpha, Score beta )
 				if ( mode.moves.empty() )
 					tt->store( board.sig(), age, bestm, best, btLower, depth, 0 );
 
-				if ( master )
+				if ( master && master->smpIterSync )
 					master->abortingSmp = 1;
 
 				return best;
@@ -840,7 +840,7 @@ Score Search::root( Depth depth, Score alpha, Score beta )
 	if ( rootMoves.count && mode.moves.empty() )
 		tt->store( board.sig(), age, bestm, best, (HashBound)(best > oalpha ? btExact : btUpper), depth, 0 );
 
-	if ( master )
+	if ( master && master->smpIterSync )
 		master->abortingSmp = 1;
 
 	return best;
@@ -862,6 +862,7 @@ i32 Search::initIteration()
 	nodeTicks = startTicks = sticks;
 
 	nodes = 0;
+	eval.stats.reset();
 
 	// increment age
 	age++;
@@ -918,6 +919,12 @@ Score Search::iterate( Board &b, const SearchMode &sm, bool nosendbest )
 
 	smpSync();
 
+	// barrier-free lazy SMP: helpers start once and iterate on their own
+	// against the shared hashtable until the final stop
+	bool smpRunning = !smpIterSync && !smpThreads.empty() && rootMoves.count;
+	if ( smpRunning )
+		smpStartIterate();
+
 	Score lastIteration = scDraw;		// last iteration score
 
 	for ( Depth d = 1; rootMoves.count && d <= maxDepth; d++ )
@@ -964,9 +971,11 @@ Score Search::iterate( Board &b, const SearchMode &sm, bool nosendbest )
 		{
 			// lazySMP kicks in here
 			abortingSmp = 0;
-			smpStart( d, -scInfinity, scInfinity );
+			if ( smpIterSync )
+				smpStart( d, -scInfinity, scInfinity );
 			res = root( d, -scInfinity, scInfinity );
-			smpStop();
+			if ( smpIterSync )
+				smpStop();
 		}
 		else
 		{
@@ -987,9 +996,11 @@ Score Search::iterate( Board &b, const SearchMode &sm, bool nosendbest )
 
 				// lazySMP kicks in here
 				abortingSmp = 0;
-				smpStart( d, alpha, beta );
+				if ( smpIterSync )
+					smpStart( d, alpha, beta );
 				Score score = root( d, alpha, beta );
-				smpStop();
+				if ( smpIterSync )
+					smpStop();
 
 				if ( aborting )
 					break;
@@ -1070,6 +1081,9 @@ Score Search::iterate( Board &b, const SearchMode &sm, bool nosendbest )
 			break;
 	}
 
+	if ( smpRunning )
+		smpStop();
+
 	if ( mode.ponder )
 	{
 		// wait for stop or ponderhit!
@@ -1110,6 +1124,69 @@ Score Search::iterate( Board &b, const SearchMode &sm, bool nosendbest )
 	return res;
 }
 
+// lazy SMP helper iterative deepening loop
+// runs aspiration searches at increasing depths until aborted by the master
+void Search::iterateHelper( Depth startDepth )
+{
+	Score lastIteration = scDraw;
+
+	for ( Depth d = startDepth; rootMoves.count && d <= maxDepth; d++ )
+	{
+		// qsearch explosion guard
+		minQsDepth = (Depth)-std::min( (int)maxDepth, (int)(d*3));
+
+		Score res;
+		if ( d == startDepth || mode.multiPV > 1 )
+			res = root( d, -scInfinity, scInfinity );
+		else
+		{
+			Score alpha = lastIteration - 15;
+			Score beta = lastIteration + 15;
+
+			for (;;)
+			{
+				alpha = std::max( -scInfinity, alpha );
+				beta = std::min( +scInfinity, beta );
+				assert( alpha < beta );
+
+				res = root( d, alpha, beta );
+
+				if ( aborting )
+					break;
+				if ( res <= alpha )
+				{
+					alpha = (alpha - lastIteration)*2;
+					alpha += lastIteration;
+				}
+				else if ( res >= beta )
+				{
+					beta = (beta - lastIteration)<<1;
+					beta += lastIteration;
+				}
+				else
+					break;
+			}
+		}
+		if ( aborting )
+			break;
+		lastIteration = res;
+	}
+}
+
+Score Search::qsearchScore( const Board &b )
+{
+	board = b;
+	rep.clear();
+	aborting = abortingSmp = 0;
+	searchFlags |= sfNoTimeout;
+	minQsDepth = -maxDepth;
+	selDepth = 0;
+	stack[0].killers.clear();
+	stack[1].killers.clear();
+	return board.inCheck() ? qsearch< 0, 1 >( 0, 0, -scInfinity, scInfinity ) :
+		qsearch< 0, 0 >( 0, 0, -scInfinity, scInfinity );
+}
+
 void Search::getBest( SearchInfo  &sinfo )
 {
 	sinfo.reset();
@@ -1205,6 +1282,7 @@ void Search::setThreads( size_t nt )
 		LazySMPThread *smpt = new LazySMPThread;
 		smpt->search.master = this;
 		smpt->search.setHashTable( tt );
+		smpt->search.eval.setSharedCaches( sharedEval ? &eval : 0 );
 		smpt->run();
 		smpThreads.push_back( smpt );
 	}
@@ -1258,6 +1336,32 @@ void Search::smpStart( Depth depth, Score alpha, Score beta )
 		smpThreads[i]->start( depth + (Depth)((i&1)^1), alpha, beta, *this );
 }
 
+void Search::smpStartIterate()
+{
+	// even helpers start one ply deeper so that helpers don't all walk the same iterations
+	for ( size_t i=0; i<smpThreads.size(); i++ )
+		smpThreads[i]->startIterate( 1 + (Depth)((i&1)^1) );
+}
+
+void Search::setSmpIterSync( bool sync )
+{
+	smpIterSync = sync;
+}
+
+void Search::setSharedEvalCache( bool shared )
+{
+	sharedEval = shared;
+	for ( size_t i=0; i<smpThreads.size(); i++ )
+		smpThreads[i]->search.eval.setSharedCaches( shared ? &eval : 0 );
+}
+
+void Search::getEvalStats( EvalStats &st ) const
+{
+	st = eval.stats;
+	for ( size_t i=0; i<smpThreads.size(); i++ )
+		st.add( smpThreads[i]->search.eval.stats );
+}
+
 void Search::smpStop()
 {
 	for ( size_t i=0; i<smpThreads.size(); i++ )
@@ -1319,14 +1423,19 @@ void LazySMPThread::work()
 		depth = c.depth;
 		alpha = c.alpha;
 		beta = c.beta;
-		search.rootMoves = c.rootMoves;
+		bool iterate = c.iterate;
+		if ( !iterate )
+			search.rootMoves = c.rootMoves;
 		search.abortRequest = 0;
 		search.aborting = 0;
 		searching = 1;
 		startedSearch.signal();
 
 		assert( !(search.searchFlags & sfNoTimeout) );
-		search.root( depth, alpha, beta );
+		if ( iterate )
+			search.iterateHelper( depth );
+		else
+			search.root( depth, alpha, beta );
 
 		searching = 0;
 		doneSearch.signal();
@@ -1346,10 +1455,24 @@ void LazySMPThread::start( Depth depth, Score alpha, Score beta, const Search &m
 	cd.depth = depth;
 	cd.alpha = alpha;
 	cd.beta = beta;
+	cd.iterate = 0;
 	cd.rootMoves = master.rootMoves;
 
 	commandEvent.signal();
 	startedSearch.wait();
 }
 
+void LazySMPThread::startIterate( Depth depth )
+{
+	// root moves were already copied by smpSync()
+	CommandData &cd = commandData;
+	cd.depth = depth;
+	cd.alpha = -scInfinity;
+	cd.beta = scInfinity;
+	cd.iterate = 1;
+
+	commandEvent.signal();
+	startedSearch.wait();
+}
+
 }
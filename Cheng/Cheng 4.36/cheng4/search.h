@@ -154,6 +154,9 @@ struct Search
 
 	size_t maxThreads;				// maximum number of helper threads allowed (i.e 0 = none; 1 thread total)
 									// defaults to 63
+	volatile bool smpIterSync;		// resynchronize helpers at each iteration (old lazy SMP scheme)
+									// defaults to 0: helpers run their own iterative deepening loop
+	bool sharedEval;				// helpers share master's eval cache and pawn hash (defaults to 0)
 	volatile bool eloLimit;			// elo limit master flag
 	volatile u32 maxElo;			// 2500 = full
 
@@ -275,6 +278,12 @@ struct Search
 	// start new search and iterate
 	Score iterate( Board &b, const SearchMode &sm, bool nosendbest = 0 );
 
+	// lazy SMP helper iterative deepening loop (runs until aborted)
+	void iterateHelper( Depth startDepth );
+
+	// static quiescence search score from stm's point of view (used by tuner)
+	Score qsearchScore( const Board &b );
+
 	// clear all helper slots
 	void clearSlots();
 
@@ -336,8 +345,19 @@ struct Search
 	// enable nullmove flag
 	void enableNullMove( bool enable );
 
+	// set lazy SMP iteration sync mode
+	void setSmpIterSync( bool sync );
+
+	// share eval cache and pawn hash with helper threads
+	void setSharedEvalCache( bool shared );
+
+	// get eval cache statistics (including helpers) for last search
+	void getEvalStats( EvalStats &st ) const;
+
 	// start root smp search
 	void smpStart( Depth depth, Score alpha, Score beta );
+	// start barrier-free smp search (helpers iterate on their own)
+	void smpStartIterate();
 	// stop root smp search
 	void smpStop();
 	// sync smp threads (before iteration starts)
@@ -361,6 +381,7 @@ public:
 		Depth depth;
 		Score alpha;
 		Score beta;
+		bool iterate;			// run own iterative deepening loop starting at depth
 		Search::RootMoves rootMoves;
 	} commandData;
 
@@ -375,6 +396,7 @@ public:
 	void destroy();
 
 	void start( Depth depth, Score alpha, Score beta, const Search &master );
+	void startIterate( Depth depth );
 	void abort();
 
 	void work();
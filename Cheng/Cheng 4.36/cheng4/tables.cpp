@@ -398,6 +398,7 @@ void Tables::init()
 // BitOp
 
 bool BitOp::hwPopCnt = 0;
+bool BitOp::hwPext = 0;
 
 // disable hardware popcount
 void BitOp::disableHwPopCount()
@@ -405,43 +406,54 @@ void BitOp::disableHwPopCount()
 	hwPopCnt = 0;
 }
 
-// static init (detects hw popcount)
-void BitOp::init()
+// cpuid helper; returns 0 if not available
+static bool cpuId( int id[4], int leaf )
 {
 #ifdef _MSC_VER
-	int id[4] = {0};
-	__cpuid(id, 0);
-	int nids = id[0];
-	if ( nids >= 2 )
-	{
-		id[2] = 0;
-		__cpuid(id, 1);
-		hwPopCnt = (id[2] & 0x800000) != 0;
-	}
-#elif defined(__GNUC__) && !defined(__ANDROID__)
-	int id[4] = {0};
+	__cpuidex( id, leaf, 0 );
+	return 1;
+#elif defined(__GNUC__) && !defined(__ANDROID__) && (defined(__i386__) || defined(__x86_64__))
 	asm(
 		"cpuid":
 		"=a" (id[0]),
 		"=b" (id[1]),
 		"=c" (id[2]),
 		"=d" (id[3]) :
-		"a" (0)
+		"a" (leaf), "c" (0)
 	);
+	return 1;
+#else
+	id[0] = id[1] = id[2] = id[3] = 0;
+	(void)leaf;
+	return 0;
+#endif
+}
+
+// static init (detects hw popcount and pext)
+void BitOp::init()
+{
+	int id[4] = {0};
+	if ( !cpuId( id, 0 ) )
+		return;
 	int nids = id[0];
-	if ( nids >= 2 )
+	// AuthenticAMD
+	bool amd = id[1] == 0x68747541 && id[3] == 0x69746e65 && id[2] == 0x444d4163;
+	if ( nids >= 1 )
 	{
-		id[2] = 0;
-		asm(
-			"cpuid":
-			"=a" (id[0]),
-			"=b" (id[1]),
-			"=c" (id[2]),
-			"=d" (id[3]) :
-			"a" (1)
-		);
+		cpuId( id, 1 );
 		hwPopCnt = (id[2] & 0x800000) != 0;
 	}
+	int family = (id[0] >> 8) & 15;
+	if ( family == 15 )
+		family += (id[0] >> 20) & 255;
+	if ( nids >= 7 )
+	{
+		cpuId( id, 7 );
+		// BMI2; pext is microcoded (very slow) on AMD before Zen 3
+		hwPext = (id[1] & 0x100) != 0 && !(amd && family < 0x19);
+	}
+#ifndef USE_PEXT
+	hwPext = 0;
 #endif
 }
 
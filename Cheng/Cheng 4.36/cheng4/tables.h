@@ -147,6 +147,11 @@ protected:
 #	define IS_X64 1
 #endif
 
+// BMI2 pext slider attacks (selected at runtime)
+#if !defined(__ANDROID__) && ((defined(__GNUC__) && defined(__x86_64__)) || (defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_X64))))
+#	define USE_PEXT
+#endif
+
 // singleton
 struct BitOp
 {
@@ -353,6 +358,40 @@ done:
 		return popCount< pcmNormal >( val );
 	}
 
+	// parallel bit extract: gather bits of val selected by mask into low bits
+	// only valid if hasFastPext()
+	static inline u64 pext( u64 val, u64 mask )
+	{
+#ifdef USE_PEXT
+	#ifdef _MSC_VER
+		return _pext_u64( val, mask );
+	#else
+		u64 res;
+		asm(
+			"pextq %2, %1, %0" :
+			"=r" (res) :
+			"r" (val), "rm" (mask)
+		);
+		return res;
+	#endif
+#else
+		return softPext( val, mask );
+#endif
+	}
+
+	// software pext
+	static inline u64 softPext( u64 val, u64 mask )
+	{
+		u64 res = 0;
+		for ( u64 bit = 1; mask; bit += bit )
+		{
+			if ( val & mask & (0-mask) )
+				res |= bit;
+			mask &= mask-1;
+		}
+		return res;
+	}
+
 	// shift bitboard one rank forward
 	template< Color c > static inline Bitboard shiftForward( Bitboard b )
 	{
@@ -391,12 +430,19 @@ done:
 	// disable hardware popcount
 	static void disableHwPopCount();
 
-	// static init (detects hw popcount)
+	// has fast hardware pext? (BMI2 and not microcoded)
+	static inline bool hasFastPext()
+	{
+		return hwPext;
+	}
+
+	// static init (detects hw popcount and pext)
 	static void init();
 
 
 private:
 	static bool hwPopCnt;
+	static bool hwPext;
 };
 
 }
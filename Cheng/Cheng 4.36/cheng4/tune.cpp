@@ -25,7 +25,15 @@ or as public domain (where applicable)
 
 #ifdef USE_TUNING
 
+#include "search.h"
+#include "psq.h"
+#include "thread.h"
 #include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
 
 namespace cheng4
 {
@@ -80,6 +88,314 @@ const TunableBase *TunableParams::getParam( size_t index )
 	return params[index];
 }
 
+// TexelTuner
+
+// pack FEN into compact position
+static bool packPosition( TexelTuner::Position &p, const char *fen )
+{
+	Board b;
+	if ( !b.fromFEN( fen ) || !b.isValid() )
+		return 0;
+	memset( &p, 0, sizeof(p) );
+	uint count = 0;
+	for ( Square sq = 0; sq < 64; sq++ )
+	{
+		Piece pc = b.piece( sq );
+		if ( PiecePack::type( pc ) == ptNone )
+			continue;
+		p.occupied |= BitOp::oneShl( sq );
+		p.pieces[ count >> 1 ] |= (u8)(pc << ((count & 1)*4));
+		count++;
+	}
+	p.flags = (u8)b.turn();
+
+	// castling and ep from canonical FEN
+	std::string cfen = b.toFEN();
+	std::stringstream stream( cfen );
+	std::string tok, castling, ep;
+	stream >> tok >> tok >> castling >> ep;
+	for ( size_t i=0; i<castling.length(); i++ )
+	{
+		const char *ch = strchr( "KQkq", castling[i] );
+		if ( ch && *ch )
+			p.flags |= (u8)(2 << (ch - "KQkq"));
+	}
+	if ( ep.length() == 2 && ep[0] >= 'a' && ep[0] <= 'h' )
+		p.epFile = (u8)(ep[0] - 'a' + 1);
+	return 1;
+}
+
+// unpack compact position into board
+static void unpackPosition( const TexelTuner::Position &p, Board &b )
+{
+	static const char pieceChars[] = " PNBRQK  pnbrqk";
+	Piece pieces[64];
+	memset( pieces, 0, sizeof(pieces) );
+	uint count = 0;
+	for ( Square sq = 0; sq < 64; sq++ )
+	{
+		if ( !(p.occupied & BitOp::oneShl( sq )) )
+			continue;
+		pieces[ sq ] = (Piece)((p.pieces[ count >> 1 ] >> ((count & 1)*4)) & 15);
+		count++;
+	}
+
+	char fen[128];
+	char *c = fen;
+	for ( Rank y = 0; y < 8; y++ )
+	{
+		Rank ry = y^RANK8;
+		uint empty = 0;
+		for ( File x = 0; x < 8; x++ )
+		{
+			Piece pc = pieces[ SquarePack::init( x, ry ) ];
+			if ( !pc )
+			{
+				empty++;
+				continue;
+			}
+			if ( empty )
+				*c++ = (char)('0' + empty);
+			empty = 0;
+			*c++ = pieceChars[ pc ];
+		}
+		if ( empty )
+			*c++ = (char)('0' + empty);
+		if ( y < 7 )
+			*c++ = '/';
+	}
+	*c++ = ' ';
+	*c++ = (p.flags & 1) ? 'b' : 'w';
+	*c++ = ' ';
+	if ( !(p.flags & 30) )
+		*c++ = '-';
+	for ( uint i=0; i<4; i++ )
+		if ( p.flags & (2 << i) )
+			*c++ = "KQkq"[i];
+	*c++ = ' ';
+	if ( p.epFile )
+	{
+		*c++ = (char)('a' + p.epFile - 1);
+		*c++ = (p.flags & 1) ? '3' : '6';
+	}
+	else
+		*c++ = '-';
+	strcpy( c, " 0 1" );
+	b.fromFEN( fen );
+}
+
+// parse result label, returns -1 if none
+static int parseResult( const char *str )
+{
+	const char *br = strchr( str, '[' );
+	if ( br )
+	{
+		double r = strtod( br+1, 0 );
+		return r > 0.75 ? 2 : r > 0.25 ? 1 : 0;
+	}
+	if ( strstr( str, "1/2" ) )
+		return 1;
+	if ( strstr( str, "1-0" ) )
+		return 2;
+	if ( strstr( str, "0-1" ) )
+		return 0;
+	return -1;
+}
+
+size_t TexelTuner::load( const char *fnm )
+{
+	std::ifstream ifs( fnm );
+	if ( !ifs )
+		return 0;
+	positions.clear();
+	scores.clear();
+	std::string line;
+	while ( std::getline( ifs, line ) )
+	{
+		// result follows the first four FEN fields
+		size_t pos = 0;
+		for ( int i=0; i<4 && pos != std::string::npos; i++ )
+		{
+			pos = line.find_first_not_of( " \t", pos );
+			if ( pos != std::string::npos )
+				pos = line.find_first_of( " \t", pos );
+		}
+		if ( pos == std::string::npos )
+			continue;
+		int res = parseResult( line.c_str() + pos );
+		if ( res < 0 )
+			continue;
+		Position p;
+		if ( !packPosition( p, line.c_str() ) )
+			continue;
+		p.result = (u8)res;
+		positions.push_back( p );
+	}
+	return positions.size();
+}
+
+class TexelWorker : public Thread
+{
+public:
+	const TexelTuner::Position *begin, *end;
+	Score *out;
+
+	void work()
+	{
+		// each worker uses its own search with fresh eval caches
+		// and a tiny hashtable cleared for each position
+		Search *s = new Search;
+		TransTable *tt = new TransTable;
+		s->setHashTable( tt );
+		Board b;
+		for ( const TexelTuner::Position *p = begin; p < end; p++ )
+		{
+			unpackPosition( *p, b );
+			tt->clear();
+			Score sc = s->qsearchScore( b );
+			*out++ = b.turn() == ctWhite ? sc : -sc;
+		}
+		delete s;
+		delete tt;
+	}
+};
+
+void TexelTuner::computeScores( uint threads )
+{
+	size_t count = positions.size();
+	scores.resize( count );
+	if ( !count )
+		return;
+	threads = (uint)std::max( 1u, std::min( threads, (uint)count ) );
+	std::vector< TexelWorker * > workers;
+	size_t chunk = (count + threads - 1) / threads;
+	for ( size_t i=0; i<count; i += chunk )
+	{
+		TexelWorker *w = new TexelWorker;
+		w->begin = &positions[i];
+		w->end = &positions[0] + std::min( count, i + chunk );
+		w->out = &scores[i];
+		w->run();
+		workers.push_back( w );
+	}
+	for ( size_t i=0; i<workers.size(); i++ )
+		workers[i]->kill();
+}
+
+double TexelTuner::error( double k ) const
+{
+	double sum = 0;
+	for ( size_t i=0; i<scores.size(); i++ )
+	{
+		double sigmoid = 1.0 / (1.0 + pow( 10.0, -k * scores[i] / 400.0 ));
+		double diff = positions[i].result * 0.5 - sigmoid;
+		sum += diff * diff;
+	}
+	return scores.empty() ? 0 : sum / (double)scores.size();
+}
+
+double TexelTuner::fitK() const
+{
+	double best = 1.0;
+	double bestError = error( best );
+	// refine in decreasing steps
+	for ( double step = 0.1; step > 0.0005; step /= 10 )
+	{
+		for (;;)
+		{
+			double e0 = error( best - step );
+			double e1 = error( best + step );
+			if ( e0 < bestError && e0 <= e1 )
+			{
+				best -= step;
+				bestError = e0;
+			}
+			else if ( e1 < bestError )
+			{
+				best += step;
+				bestError = e1;
+			}
+			else
+				break;
+		}
+	}
+	return best;
+}
+
+static long getParamValue( size_t index )
+{
+	return strtol( TunableParams::getParam( index )->get().c_str(), 0, 10 );
+}
+
+static void setParamValue( size_t index, long value )
+{
+	std::stringstream stream;
+	stream << value;
+	TunableParams::params[ index ]->set( stream.str().c_str() );
+	// psq tables are derived from material/psq scales
+	PSq::init();
+}
+
+void TexelTuner::tune( uint threads, uint passes )
+{
+	i32 ticks = Timer::getMillisec();
+	computeScores( threads );
+	i32 scoreTicks = Timer::getMillisec() - ticks;
+	ticks = Timer::getMillisec();
+	double k = fitK();
+	i32 fitTicks = Timer::getMillisec() - ticks;
+	double best = error( k );
+	std::cout << positions.size() << " positions, K = " << k << ", error = " << best
+		<< " (" << scoreTicks << " msec per scoring pass, " << fitTicks << " msec fitK)" << std::endl;
+
+	// per-param step starts at 1/32 of the magnitude and halves when neither direction helps
+	size_t count = TunableParams::paramCount();
+	std::vector< long > steps( count );
+	for ( size_t i=0; i<count; i++ )
+		steps[i] = std::max( 1l, std::abs( getParamValue(i) ) / 32 );
+
+	for ( uint pass = 0; pass < passes; pass++ )
+	{
+		bool changed = 0;
+		for ( size_t i=0; i<count; i++ )
+		{
+			long value = getParamValue(i);
+			long tries[2] = { value + steps[i], value - steps[i] };
+			bool improved = 0;
+			for ( int j=0; j<2 && !improved; j++ )
+			{
+				setParamValue( i, tries[j] );
+				computeScores( threads );
+				double e = error( k );
+				if ( e < best )
+				{
+					best = e;
+					improved = 1;
+				}
+			}
+			if ( improved )
+			{
+				changed = 1;
+				std::cout << TunableParams::getParam(i)->name() << " = " << getParamValue(i)
+					<< " error = " << best << std::endl;
+				continue;
+			}
+			setParamValue( i, value );
+			if ( steps[i] > 1 )
+			{
+				steps[i] /= 2;
+				changed = 1;
+			}
+		}
+		std::cout << "pass " << pass+1 << " error = " << best << std::endl;
+		if ( !changed )
+			break;
+	}
+	computeScores( threads );
+	TunableParams::dump();
+	std::cout.flush();
+}
+
 }
 
 #endif
@@ -30,6 +30,7 @@ or as public domain (where applicable)
 #	include <vector>
 #	include <string>
 #	include <sstream>
+#	include "chtypes.h"
 
 #	define TUNE_CONST
 #	define TUNE_EXPORT(x, y, z) static const Tunable<x> tunable_##y(&z, #y)
@@ -59,6 +60,44 @@ public:
 	static void dump();
 };
 
+// Texel-style tuner: fits tunable params to game results
+// using quiescence search scores of labelled positions
+class TexelTuner
+{
+public:
+	// compact position (32 bytes)
+	struct Position
+	{
+		u64 occupied;		// occupied squares
+		u8 pieces[16];		// 4 bits per piece in occupied order
+		u8 flags;			// bit 0: stm, bits 1-4: KQkq castling
+		u8 epFile;			// ep file+1 (0 = none)
+		u8 result;			// 0 = black wins, 1 = draw, 2 = white wins
+		u8 pad[5];
+	};
+
+	// load labelled positions: one FEN per line followed by result
+	// (1-0, 0-1, 1/2-1/2 or [1.0], [0.5], [0.0])
+	// returns number of positions loaded
+	size_t load( const char *fnm );
+
+	// compute qsearch scores (white's point of view) for all positions
+	void computeScores( uint threads );
+
+	// mean squared error for scaling constant k using last computed scores
+	double error( double k ) const;
+
+	// find scaling constant k minimizing error
+	double fitK() const;
+
+	// local search over all tunable params
+	void tune( uint threads, uint passes );
+
+private:
+	std::vector< Position > positions;
+	std::vector< Score > scores;
+};
+
 // this represents a tunable parameter
 template< typename T > class Tunable : public TunableBase
 {
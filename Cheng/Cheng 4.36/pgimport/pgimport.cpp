@@ -25,14 +25,13 @@ or as public domain (where applicable)
 #include "../cheng4/engine.h"
 #include "../cheng4/book.h"
 #include "../cheng4/movegen.h"
+#include "../cheng4/thread.h"
 #include <stdio.h>
 #include "pgzobrist.h"
 #include <string>
-#include <set>
+#include <vector>
 #include <algorithm>
 
-//#define USE_SEARCH
-
 namespace pgimport
 {
 
@@ -114,32 +113,6 @@ static u64 PGHashPiece( cheng4::Piece p, cheng4::Square sq )
 	return res;
 }
 
-static cheng4::Move PGMove( u16 m, const cheng4::Board &b )
-{
-	cheng4::Square from = cheng4::SquarePack::flipV( (cheng4::Square)((m >> 6) & 63) );
-	cheng4::Square to = cheng4::SquarePack::flipV( (cheng4::Square)(m & 63) );
-
-	// special case: convert king captures rook => castling (always king captures rook in polyglot!)
-	cheng4::Piece pf = b.piece( from );
-	cheng4::Piece pt = b.piece( to );
-	if ( cheng4::PiecePack::type( pf ) == cheng4::ptKing )
-	{
-		if ( cheng4::PiecePack::type( pt ) == cheng4::ptRook &&
-			cheng4::PiecePack::color( pf ) == cheng4::PiecePack::color( pt ) )
-		{
-			cheng4::File kf = cheng4::SquarePack::file( to ) >= cheng4::SquarePack::file( from )
-				? cheng4::GFILE : cheng4::CFILE;
-			to = cheng4::SquarePack::setFile( to, kf );
-			return cheng4::MovePack::initCastling( from, to );
-		}
-	}
-
-	u8 promo = (m >> 12) & 7;
-	if ( promo )
-		promo += 1;
-	return cheng4::MovePack::initPromo( from, to, promo );
-}
-
 static u64 PGHash( const cheng4::Board &b )
 {
 	u64 res = 0;
@@ -192,338 +165,319 @@ static u64 PGHash( const cheng4::Board &b )
 	return res;
 }
 
-struct PGBook
+// sharded worker: sorts or merges a range of entries
+class SortWorker : public cheng4::Thread
 {
-	u32 entries;
-	FILE *f;
-
-	bool readEntry( u32 index, PGEntry &ent )
-	{
-		if ( index >= entries )
-			return 0;
-		fseek(f, (long)index*16, SEEK_SET );
-		bool ok = fread( &ent, 16, 1, f ) == 1;
-		ent.byteSwap();
-		//
-		// first sum all counts for all moves
-		// second, compute score as (double(score)/double(sum))*100.0, where score is count for current move
-		return ok;
-	}
-
-	// find leftmost entry
-	u32 find( u64 sig )
-	{
-		PGEntry ent;
-		i32 l = 0;
-		i32 h = (i32)entries-1;
-		while ( l<h )
-		{
-			i32 m = (l+h)/2;
-			if ( !readEntry( (u32)m, ent ) )
-				return 0;
-			if ( sig <= ent.key )
-				h = m;
-			else
-				l = m+1;
-		}
-		if ( !readEntry( (u32)l, ent ) )
-			return 0;
-		return ent.key == sig ? l : entries;
-	}
+public:
+	PGEntry *begin, *mid, *end;
 
-	void init( u64 fsz, FILE *f_ )
+	void work()
 	{
-		f = f_;
-		entries = (u32)(fsz/16);
+		if ( mid )
+			std::inplace_merge( begin, mid, end );
+		else
+			std::sort( begin, end );
 	}
 };
 
-void convertEntry( const PGEntry &ent, cheng4::BookEntry &oute, const cheng4::Board &b )
-{
-	oute.sig = b.sig();
-	oute.count = ent.count;
-	oute.move = (cheng4::BookMove)(PGMove( ent.move, b ) & 0xffffu);
-}
-
-std::set< cheng4::Signature > processed;
-std::vector< cheng4::Signature > stack;
-std::set< u64 > bookHashes;
-
-bool convertBook( FILE *f2, PGBook &book, cheng4::Board &b, u32 &poscnt, u32 fulldepth = 0 )
+// sort shards in parallel, then merge them pairwise (each level in parallel)
+static void parallelSort( std::vector< PGEntry > &entries, u32 threads )
 {
-	for ( size_t i=0; i<stack.size(); i++ )
-		if ( stack[i] == b.sig() )
-			return 0;
-	if ( processed.find( b.sig() ) != processed.end() )
-		return 0;
-	stack.push_back( b.sig() );
-	PGEntry ent;
-	u64 sig = PGHash( b );
-	u32 e = bookHashes.find(sig) == bookHashes.end() ? book.entries : book.find( sig );
-	if ( e >= book.entries && fulldepth <= 1 )
+	size_t n = entries.size();
+	if ( n < 2 )
+		return;
+	threads = std::max( 1u, std::min( threads, (u32)(n/1024 + 1) ) );
+
+	std::vector< size_t > bounds;
+	for ( u32 i=0; i<threads; i++ )
+		bounds.push_back( n*i/threads );
+	bounds.push_back( n );
+
+	PGEntry *base = &entries[0];
+	std::vector< SortWorker * > workers;
+	for ( size_t i=0; i+1<bounds.size(); i++ )
 	{
-		bool res = 0;
-#ifdef USE_SEARCH
-		cheng4::MoveGen *mg = new cheng4::MoveGen( b );
-		cheng4::Move lm;
-		while ( (lm = mg->next()) != cheng4::mcNone )
-		{
-			cheng4::UndoInfo ui;
-			b.doMove( lm, ui, b.isCheck( lm, mg->discovered() ) );
-			if ( convertBook( f2, book, b, poscnt, fulldepth+1 ) )
-			{
-				res = 1;
-			}
-			b.undoMove( ui );
-		}
-		delete mg;
-/*		std::cout << "entry not found!!!\n";
-		b.dump();
-		sig = PGHash( b );*/
-#endif
-		return res;
+		SortWorker *w = new SortWorker;
+		w->begin = base + bounds[i];
+		w->mid = 0;
+		w->end = base + bounds[i+1];
+		w->run();
+		workers.push_back( w );
 	}
-	bool res = 1;
-	bool firstTime = 1;
-	while ( book.readEntry( e, ent ) && ent.key == sig )
-	{
-		fulldepth = 0;
-		if ( firstTime )
-		{
-			processed.insert( b.sig() );
-			firstTime = 0;
-		}
-		std::set< cheng4::Move > movesProcessed;
-		cheng4::Move m = PGMove( ent.move, b );
-		cheng4::Move lm;
-		cheng4::MoveGen *mg = new cheng4::MoveGen( b );
-		while ( (lm = mg->next()) != cheng4::mcNone )
-		{
-			if ( cheng4::MovePack::equalBook( lm, m ) )
-				break;
-		}
-		if ( lm == cheng4::mcNone )
-		{
-			std::cout << "Error! illegal move in pg book!" << std::endl;
-			b.dump();
-			std::cout << "move: " << cheng4::MovePack::toUCI( m ) << std::endl;
-			abort();
-		}
-		movesProcessed.insert( lm );
-		cheng4::BookEntry be;
-		convertEntry( ent, be, b );
-		fwrite( &be, sizeof(be), 1, f2 );
-
-		if ( !(poscnt++ & 1023) )
-		{
-			std::cout << poscnt << " ";
-		}
-
-		cheng4::UndoInfo ui;
-		b.doMove( lm, ui, b.isCheck(lm, mg->discovered()) );
-		convertBook( f2, book, b, poscnt, fulldepth+1 );
-		b.undoMove( ui );
+	for ( size_t i=0; i<workers.size(); i++ )
+		workers[i]->kill();
 
-		delete mg;
-
-#ifdef USE_SEARCH
-		// do the rest
+	while ( bounds.size() > 2 )
+	{
+		size_t ranges = bounds.size()-1;
+		std::vector< size_t > nbounds;
+		workers.clear();
+		for ( size_t i=0; i+1<ranges; i += 2 )
 		{
-			cheng4::MoveGen *mg = new cheng4::MoveGen( b );
-			cheng4::Move lm;
-			while ( (lm = mg->next()) != cheng4::mcNone )
-			{
-				if ( movesProcessed.find(lm) != movesProcessed.end() )
-					continue;
-				cheng4::UndoInfo ui;
-				b.doMove( lm, ui, b.isCheck( lm, mg->discovered() ) );
-				convertBook( f2, book, b, poscnt, fulldepth+1 );
-				b.undoMove(ui);
-			}
-			delete mg;
+			SortWorker *w = new SortWorker;
+			w->begin = base + bounds[i];
+			w->mid = base + bounds[i+1];
+			w->end = base + bounds[i+2];
+			w->run();
+			workers.push_back( w );
+			nbounds.push_back( bounds[i] );
 		}
-#endif
-
-		e++;
+		if ( ranges & 1 )
+			nbounds.push_back( bounds[ranges-1] );
+		nbounds.push_back( n );
+		for ( size_t i=0; i<workers.size(); i++ )
+			workers[i]->kill();
+		bounds.swap( nbounds );
 	}
-	stack.pop_back();
-	return res;
 }
 
-static bool entcmp( const cheng4::BookEntry &e1, const cheng4::BookEntry &e2 )
+static inline bool sameMove( const PGEntry &e1, const PGEntry &e2 )
 {
-	if ( e1.sig != e2.sig )
-		return e1.sig < e2.sig;
-	if ( e1.count != e2.count )
-		return e1.count > e2.count;
-	return e1.move < e2.move;
+	return e1.key == e2.key && e1.move == e2.move;
 }
 
-void sortBook( const char *fnm )
-{
-	std::cout << "sorting..." << std::endl;
-	FILE *f = fopen(fnm, "rb");
-	fseek(f, 0, SEEK_END);
-	long fsz = ftell(f);
-	fseek(f, 0, SEEK_SET );
-	u32 ent = (u32)(fsz/16);
-	cheng4::BookEntry *e = new cheng4::BookEntry[ ent ];
-	fread( e, 16, ent, f );
-	fclose(f);
-
-	std::sort( e, e+ent, entcmp );
-	f = fopen("test.cbs", "wb");
-	fwrite( e, 16, ent, f );
-	fclose(f);
-
-	std::cout << "validating.." << std::endl;
-	for ( u32 i=1; i<ent; i++ )
-	{
-		if ( e[i].sig == e[i-1].sig && e[i].move == e[i-1].move )
-		{
-			std::cout << "DUP_ENTRY_FOUND!" << std::endl;
-		}
-	}
-
-	delete[] e;
-}
-
-static u16 toPGMove( Move m, const Board &b )
+static u16 toPGMove( cheng4::Move m, const cheng4::Board &b )
 {
 	u16 res;
-	Square from = MovePack::from(m);
-	Square to = MovePack::to(m);
-	if ( MovePack::isCastling(m) )
+	cheng4::Square from = cheng4::MovePack::from(m);
+	cheng4::Square to = cheng4::MovePack::to(m);
+	if ( cheng4::MovePack::isCastling(m) )
 	{
 		// convert to => rook capture
-		CastRights cr = b.castRights( b.turn() );
-		to = CastPack::rookSquare( to, cr );
+		cheng4::CastRights cr = b.castRights( b.turn() );
+		to = cheng4::CastPack::rookSquare( to, cr );
 	}
-	from = SquarePack::flipV( from );
-	to = SquarePack::flipV( to );
-	res = (from << 6) | to;
-	if ( MovePack::isPromo(m) )
+	from = cheng4::SquarePack::flipV( from );
+	to = cheng4::SquarePack::flipV( to );
+	res = (u16)((from << 6) | to);
+	if ( cheng4::MovePack::isPromo(m) )
 	{
-		Piece promo = MovePack::promo( m );
-		res |= (promo-1) << 12;
+		cheng4::Piece promo = cheng4::MovePack::promo( m );
+		res |= (u16)((promo-1) << 12);
 	}
 	return res;
 }
 
-void convertLine( const char *buf, std::set< PGEntry > &book )
+// convert one SAN book line, returns number of positions
+static u32 convertLine( const char *buf, std::vector< PGEntry > &book )
 {
-	Board b;
+	u32 res = 0;
+	cheng4::Board b;
 	b.reset();
 	for (;;)
 	{
 		while (isspace(*buf))
 			buf++;
-		Move m = b.fromSAN(buf);
-		if ( m == mcNone )
+		cheng4::Move m = b.fromSAN(buf);
+		if ( m == cheng4::mcNone )
 			break;
 		PGEntry e;
 		e.n = e.sum = 0;
 		e.count = 2;
 		e.move = toPGMove( m, b );
 		e.key = PGHash(b);
-		book.insert(e);
+		book.push_back(e);
+		res++;
 
-		UndoInfo ui;
+		cheng4::UndoInfo ui;
 		bool isCheck = b.isCheck( m, b.discovered() );
 		b.doMove( m, ui, isCheck );
 	}
+	return res;
 }
 
-void convertBookLines( const char *fnm, const char *ofnm )
+// sharded worker: converts a slice of a batch of book lines
+class LineWorker : public cheng4::Thread
 {
-	std::set< PGEntry > book;
-	char buf[4096];
-	FILE *f = fopen(fnm, "r");
-	while ( fgets(buf, sizeof(buf), f) )
-		convertLine( buf, book );
-	fclose(f);
-	// now: write out!
-	FILE *f2 = fopen(ofnm, "wb");
-	std::set< PGEntry >::const_iterator ci;
-	for ( ci=book.begin(); ci != book.end(); ci++ )
+public:
+	const std::vector< std::string > *lines;
+	size_t begin, end;
+	std::vector< PGEntry > entries;
+	u32 positions;
+
+	void work()
 	{
-		PGEntry ent = *ci;
-		ent.byteSwap();
-		fwrite( &ent, sizeof(ent), 1, f2 );
+		positions = 0;
+		for ( size_t i=begin; i<end; i++ )
+			positions += convertLine( (*lines)[i].c_str(), entries );
 	}
-	fclose(f2);
-}
+};
 
-int main( int argc, char **argv )
+// stream book lines in batches, each batch is sharded across threads
+// returns number of positions processed
+static u64 readBookLines( FILE *f, std::vector< PGEntry > &book, u32 threads )
 {
-	cheng4::Engine::init();
+	static const size_t batchLines = 65536;
+	u64 res = 0;
+	char buf[4096];
+	std::vector< std::string > lines;
+	size_t compacted = 0;
+	bool eof = 0;
+	while ( !eof )
+	{
+		lines.clear();
+		while ( lines.size() < batchLines )
+		{
+			if ( !fgets(buf, sizeof(buf), f) )
+			{
+				eof = 1;
+				break;
+			}
+			lines.push_back( buf );
+		}
+		if ( lines.empty() )
+			break;
 
-/*	// new: use generic book lines...
-	convertBookLines("booklines.txt", "booklines.bin");
-	return 0;*/
+		std::vector< LineWorker * > workers;
+		u32 shards = std::max( 1u, std::min( threads, (u32)lines.size() ) );
+		for ( u32 i=0; i<shards; i++ )
+		{
+			LineWorker *w = new LineWorker;
+			w->lines = &lines;
+			w->begin = lines.size()*i/shards;
+			w->end = lines.size()*(i+1)/shards;
+			w->run();
+			workers.push_back( w );
+		}
+		for ( size_t i=0; i<workers.size(); i++ )
+		{
+			LineWorker *w = workers[i];
+			w->wait();
+			book.insert( book.end(), w->entries.begin(), w->entries.end() );
+			res += w->positions;
+			w->kill();
+		}
 
-	PGBook book;
-	FILE *f2 = fopen("cheng2014.cb", "wb");
-	FILE *f = fopen(argc > 1 ? argv[1] : "booklines.bin", "rb");
-	if ( !f )
-	{
-		std::cout << "unable to open input book" << std::endl;
-		fclose(f2);
-		return 1;
+		// lines share prefixes => compact duplicates to keep memory bounded
+		if ( book.size() > 2*compacted + batchLines )
+		{
+			parallelSort( book, threads );
+			book.erase( std::unique( book.begin(), book.end(), sameMove ), book.end() );
+			compacted = book.size();
+		}
 	}
-	fseek(f, 0, SEEK_END);
-	long fsz = ftell(f);
-	book.init( fsz, f );
-	std::cout << "PG Book: " << book.entries << " entries" << std::endl;
-
-	cheng4::Board b;
-	b.reset();
+	return res;
+}
 
-	for (u32 i=0; i<book.entries; i++)
+// stream polyglot book entries
+// returns number of entries read
+static u64 readPGBook( FILE *f, std::vector< PGEntry > &book )
+{
+	static const size_t chunk = 4096;
+	PGEntry buf[ chunk ];
+	size_t n;
+	u64 res = 0;
+	while ( (n = fread( buf, 16, chunk, f )) > 0 )
 	{
-		PGEntry ent;
-		book.readEntry( i, ent );
-		bookHashes.insert( ent.key );
+		for ( size_t i=0; i<n; i++ )
+			buf[i].byteSwap();
+		book.insert( book.end(), buf, buf+n );
+		res += n;
 	}
+	return res;
+}
 
-	std::cout << "Book positions: " << bookHashes.size() << std::endl;
+// write sorted entries as cheng book in one sequential pass
+static bool writeBook( const char *ofnm, const std::vector< PGEntry > &entries )
+{
+	// bits and position count go into the header, so compute them first
+	pgimport::BookBits bbits;
+	bbits.clear();
+	u32 npos = 0;
+	for ( size_t i=0; i<entries.size(); i++ )
+	{
+		if ( !i || entries[i].key != entries[i-1].key )
+			npos++;
+		bbits.set( entries[i].key );
+	}
 
-	u32 poscnt = 0;
+	FILE *f2 = fopen( ofnm, "wb" );
+	if ( !f2 )
+		return 0;
 
 	char header[16] = "generic book   ";
 	fwrite( header, 16, 1, f2 );
-	u32 sz = (u32)book.entries;
+	u32 sz = (u32)entries.size();
 	fwrite( &sz, 4, 1, f2 );
-	u32 npos = (u32)bookHashes.size();
 	fwrite( &npos, 4, 1, f2 );
 	u32 pad[2] = {0, 0};
 	fwrite( pad, sizeof(pad), 1, f2 );
-	pgimport::BookBits bbits;
-	bbits.clear();
 	fwrite( &bbits, sizeof(bbits), 1, f2 );
-	std::vector< PGEntry > entries(book.entries);
-	for (u32 i=0; i<book.entries; i++)
+
+	// 12-byte BookEntry records: sig, move, count
+	static const size_t chunk = 4096;
+	u8 buf[ chunk*12 ];
+	for ( size_t i=0; i<entries.size(); i += chunk )
 	{
-		PGEntry ent;
-		book.readEntry( i, ent );
-		entries[i] = ent;
-		poscnt++;
+		size_t n = std::min( chunk, entries.size() - i );
+		for ( size_t j=0; j<n; j++ )
+		{
+			const PGEntry &ent = entries[i+j];
+			memcpy( buf + j*12, &ent.key, 8 );
+			memcpy( buf + j*12 + 8, &ent.move, 2 );
+			memcpy( buf + j*12 + 10, &ent.count, 2 );
+		}
+		fwrite( buf, 12, n, f2 );
 	}
-	// sort now!
-	std::sort( entries.begin(), entries.end() );
-	for (u32 i=0; i<book.entries; i++)
+	bool ok = !ferror( f2 );
+	fclose( f2 );
+	return ok;
+}
+
+// usage: pgimport [book.bin | -lines booklines.txt] [out.cb] [threads]
+int main( int argc, char **argv )
+{
+	cheng4::Engine::init();
+
+	int argi = 1;
+	bool lines = argc > argi && !strcmp( argv[argi], "-lines" );
+	if ( lines )
+		argi++;
+	const char *ifnm = argc > argi ? argv[argi] : (lines ? "booklines.txt" : "booklines.bin");
+	argi++;
+	const char *ofnm = argc > argi ? argv[argi] : "cheng2014.cb";
+	argi++;
+	u32 threads = argc > argi ? (u32)std::max( 1, atoi( argv[argi] ) ) : 4;
+
+	FILE *f = fopen( ifnm, lines ? "r" : "rb" );
+	if ( !f )
 	{
-		PGEntry &ent = entries[i];
-		bbits.set( ent.key );
-		fwrite( &ent, 12, 1, f2 );
+		std::cout << "unable to open input book" << std::endl;
+		return 1;
 	}
-	fseek(f2, 32, SEEK_SET );
-	fwrite( &bbits, sizeof(bbits), 1, f2 );
 
-	std::cout << "Done: " << poscnt << " entries converted" << std::endl;
+	i32 ticks = cheng4::Timer::getMillisec();
 
+	std::vector< PGEntry > entries;
+	u64 positions;
+	if ( lines )
+		positions = readBookLines( f, entries, threads );
+	else
+	{
+		fseek(f, 0, SEEK_END);
+		long fsz = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		entries.reserve( (size_t)(fsz/16) );
+		positions = readPGBook( f, entries );
+		std::cout << "PG Book: " << entries.size() << " entries" << std::endl;
+	}
 	fclose(f);
-	fclose(f2);
+
+	parallelSort( entries, threads );
+	// book lines share prefixes => drop duplicate moves
+	entries.erase( std::unique( entries.begin(), entries.end(), sameMove ), entries.end() );
+
+	if ( !writeBook( ofnm, entries ) )
+	{
+		std::cout << "unable to write output book" << std::endl;
+		return 1;
+	}
+
+	ticks = cheng4::Timer::getMillisec() - ticks;
+
+	std::cout << "Done: " << positions << " positions, " << entries.size() << " entries converted in "
+		<< ticks << " ms (" << positions*1000/(u64)(ticks ? ticks : 1) << " positions/sec, "
+		<< threads << " threads)" << std::endl;
 
 	cheng4::Engine::done();
 	return 0;
@@ -230,6 +230,13 @@ typedef struct {
 typedef struct {
   BITBOARD entry[4];
 } PXOR;
+typedef struct {
+  BITBOARD generated;
+  BITBOARD made;
+  BITBOARD gen_time;
+  BITBOARD make_time;
+  BITBOARD hits;
+} PERFT_STATS;
 typedef struct {
   int path[MAXPLY];
   unsigned char pathh;
@@ -305,6 +312,7 @@ struct tree {
   unsigned int fail_high;
   unsigned int fail_high_first;
   unsigned int evaluations;
+  unsigned int eval_hash_hits;
   unsigned int egtb_probes;
   unsigned int egtb_probes_successful;
   unsigned int extensions_done;
@@ -476,6 +484,7 @@ void InitializeAttackBoards(void);
 void InitializeChessBoard(TREE *);
 int InitializeGetLogID();
 void InitializeHashTables(void);
+void InitializeEvalHashTable(void);
 void InitializeKillers(void);
 void InitializeKingSafety(void);
 void InitializeMagic(void);
@@ -506,7 +515,9 @@ int NextRootMove(TREE * RESTRICT, TREE * RESTRICT, int);
 int NextRootMoveParallel(void);
 int Option(TREE * RESTRICT);
 int OptionMatch(char *, char *);
-void OptionPerft(TREE * RESTRICT, int, int, int);
+BITBOARD OptionPerft(TREE * RESTRICT, int, int, int, PERFT_STATS *);
+BITBOARD OptionPerftRoot(TREE * RESTRICT, int, int, int);
+void *STDCALL OptionPerftThread(void *);
 void Output(TREE * RESTRICT, int, int);
 char *OutputMove(TREE * RESTRICT, int, int, int);
 int ParseTime(char *);
@@ -523,6 +534,7 @@ int Read(int, char *);
 int ReadChessMove(TREE * RESTRICT, FILE *, int, int);
 void ReadClear(void);
 unsigned int ReadClock(void);
+BITBOARD ReadClockMicro(void);
 int ReadPGN(FILE *, int);
 int ReadNextMove(TREE * RESTRICT, char *, int, int);
 int ReadParse(char *, char *args[], char *);
@@ -45,6 +45,7 @@ BITBOARD book_learn_key;
 HASH_ENTRY *trans_ref;
 HPATH_ENTRY *hash_path;
 PAWN_HASH_ENTRY *pawn_hash_table;
+HASH_ENTRY *eval_hash_table;
 void * segments[MAX_BLOCKS + 32][2];
 int nsegments = 0;
 PATH last_pv;
@@ -585,7 +586,7 @@ unsigned int elapsed_start, elapsed_end;
 TREE *block[MAX_BLOCKS + 1];
 TREE *volatile thread[CPUS];
 #if (CPUS > 1)
-lock_t lock_smp, lock_io, lock_root;
+lock_t lock_smp, lock_io, lock_root, perft_lock;
 #if defined(UNIX)
   pthread_attr_t attributes;
 #endif
@@ -596,6 +597,15 @@ unsigned int max_split_blocks;
 volatile int smp_idle = 0;
 volatile int smp_threads = 0;
 volatile int initialized_threads = 0;
+TREE *perft_tree;
+PERFT_STATS perft_stats[CPUS];
+BITBOARD perft_root_nodes[256];
+int perft_root_moves[256];
+int perft_root_count;
+int perft_depth;
+int perft_wtm;
+volatile int perft_next_root;
+volatile int perft_threads_done;
 int crafty_is_white = 0;
 unsigned int nodes_between_time_checks = 1000000;
 unsigned int nodes_per_second = 1000000;
@@ -638,7 +648,7 @@ int show_book = 0;
 int book_selection_width = 5;
 int ponder = 1;
 int trace_level = 0;
-/*  for the following 6 lines, each pair should have */
+/*  for the following 8 lines, each pair should have */
 /*  the same numeric value (the size value).         */
 size_t hash_table_size = 524288;
 BITBOARD hash_mask = (524288 -1) >> 2;
@@ -646,6 +656,8 @@ size_t hash_path_size = 32768;
 BITBOARD hash_path_mask = (32768 - 1) >> 4;
 size_t pawn_hash_table_size = 16384;
 BITBOARD pawn_hash_mask = 16384 - 1;
+size_t eval_hash_table_size = 32768;
+BITBOARD eval_hash_mask = 32768 - 1;
 int abs_draw_score = 1;
 int accept_draws = 1;
 const char translate[13] =
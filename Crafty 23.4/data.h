@@ -167,7 +167,7 @@ extern TREE *block[MAX_BLOCKS + 1];
 extern TREE *volatile thread[CPUS];
 
 #  if (CPUS > 1)
-extern lock_t lock_smp, lock_io, lock_root;
+extern lock_t lock_smp, lock_io, lock_root, perft_lock;
 
 #    if defined(UNIX)
 extern pthread_attr_t attributes;
@@ -179,6 +179,15 @@ extern unsigned int max_split_blocks;
 extern volatile int smp_idle;
 extern volatile int smp_threads;
 extern volatile int initialized_threads;
+extern TREE *perft_tree;
+extern PERFT_STATS perft_stats[CPUS];
+extern BITBOARD perft_root_nodes[256];
+extern int perft_root_moves[256];
+extern int perft_root_count;
+extern int perft_depth;
+extern int perft_wtm;
+extern volatile int perft_next_root;
+extern volatile int perft_threads_done;
 extern int crafty_is_white;
 extern unsigned int nodes_between_time_checks;
 extern unsigned int nodes_per_second;
@@ -234,9 +243,12 @@ extern BITBOARD hash_path_mask;
 extern size_t pawn_hash_table_size;
 extern BITBOARD hash_mask;
 extern BITBOARD pawn_hash_mask;
+extern size_t eval_hash_table_size;
+extern BITBOARD eval_hash_mask;
 extern HASH_ENTRY *trans_ref;
 extern HPATH_ENTRY *hash_path;
 extern PAWN_HASH_ENTRY *pawn_hash_table;
+extern HASH_ENTRY *eval_hash_table;
 extern void *segments[MAX_BLOCKS + 32][2];
 extern int nsegments;
 extern const int p_values[13];
@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 06/20/10 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -13,13 +13,27 @@
  *   considers the pawn shelter around the king along with material present to *
  *   facilitate an attack.                                                     *
  *                                                                             *
+ *   Complete evaluations are saved in the evaluation hash table, which uses  *
+ *   the same lockless (xor) scheme as the trans/ref table, so that the many  *
+ *   repeated calls from Quiesce() for the same position are nearly free.  An *
+ *   eval hash entry packs the following into its 64 bit data word:           *
+ *                                                                             *
+ *     shr  bits     name description                                          *
+ *      55   9       age  search id, entries from older searches are ignored  *
+ *                        since draw scores and root castling status change.  *
+ *      17   4   context  root castling rights and "has castled" status for   *
+ *                        each side, which are not part of the hash signature. *
+ *       0  17     value  unsigned integer value of this position + 65536.     *
+ *                                                                             *
  *******************************************************************************
  */
 int Evaluate(TREE * RESTRICT tree, int ply, int wtm, int alpha, int beta) {
   PAWN_HASH_ENTRY *ptable;
   PXOR *pxtable;
+  HASH_ENTRY *etable = 0;
+  BITBOARD word1, word2, temp_hashkey = 0, pawn_words[4];
   int score, side, majors, minors, can_win = 3;
-  int phase, lscore, cutoff;
+  int phase, lscore, cutoff, context = 0, full = 0;
 
 /*
  **********************************************************************
@@ -39,6 +53,39 @@ int Evaluate(TREE * RESTRICT tree, int ply, int wtm, int alpha, int beta) {
       TotalPieces(black, occupied) > 13)
       || (TotalPieces(black, rook) > 1 && TotalPieces(black, occupied) > 15);
   tree->evaluations++;
+/*
+ **********************************************************************
+ *                                                                    *
+ *   Check the evaluation hash table.  The signature is the normal    *
+ *   hash signature (complemented for black to move as in HashProbe() *
+ *   since the side on move changes the score).  The data word is     *
+ *   only trusted if the lockless xor check matches, it was stored    *
+ *   during this search, and the castling context matches, since the  *
+ *   development terms depend on the castling status at the root and  *
+ *   not just the current rights.  Positions near the 50-move limit   *
+ *   are scaled by the rule-50 counter which is not hashed, so they   *
+ *   bypass the table completely.                                     *
+ *                                                                    *
+ **********************************************************************
+ */
+  if (eval_hash_table && Rule50Moves(ply) <= 80
+#if defined(SKILL)
+      && skill >= 100
+#endif
+      ) {
+    context =
+        (Castle(1, white) > 0) | ((Castle(1, black) > 0) << 1) |
+        ((Castle(ply, white) < 0) << 2) | ((Castle(ply, black) < 0) << 3);
+    temp_hashkey = (wtm) ? HashKey : ~HashKey;
+    etable = eval_hash_table + (temp_hashkey & eval_hash_mask);
+    word1 = etable->word1;
+    word2 = etable->word2 ^ word1;
+    if (word2 == temp_hashkey && word1 >> 55 == transposition_age &&
+        ((word1 >> 17) & 15) == context) {
+      tree->eval_hash_hits++;
+      return ((int) (word1 & 0x1ffff) - 65536);
+    }
+  }
   tree->score_mg = 0;
   tree->score_eg = 0;
   EvaluateMaterial(tree, wtm);
@@ -180,25 +227,43 @@ int Evaluate(TREE * RESTRICT tree, int ply, int wtm, int alpha, int beta) {
  *   before.  If so, we can skip the work saved in the pawn *
  *   hash table.                                            *
  *                                                          *
+ *   The pawn hash table is shared by all threads and uses  *
+ *   the same lockless approach as the trans/ref table (see *
+ *   HashProbe() for details).  The stored key is the real  *
+ *   signature xor'ed with the three data words, so an      *
+ *   entry that was torn by simultaneous stores from two    *
+ *   threads will simply fail to match.  We snapshot the    *
+ *   four words once, verify the snapshot, and only then    *
+ *   copy it into the tree, so that torn data never reaches *
+ *   the pawn scoring code, even for an instant.            *
+ *                                                          *
  ************************************************************
  */
     else {
       ptable = pawn_hash_table + (PawnHashKey & pawn_hash_mask);
-      pxtable = (PXOR *) & (tree->pawn_score);
-      tree->pawn_score = *ptable;
-      tree->pawn_score.key ^=
-          pxtable->entry[1] ^ pxtable->entry[2] ^ pxtable->entry[3];
-      if (tree->pawn_score.key != PawnHashKey) {
+      pxtable = (PXOR *) ptable;
+      pawn_words[0] = pxtable->entry[0];
+      pawn_words[1] = pxtable->entry[1];
+      pawn_words[2] = pxtable->entry[2];
+      pawn_words[3] = pxtable->entry[3];
+      if ((pawn_words[0] ^ pawn_words[1] ^ pawn_words[2] ^ pawn_words[3]) ==
+          PawnHashKey) {
+        memcpy((char *) &(tree->pawn_score), (char *) pawn_words, 32);
+        tree->pawn_score.key = PawnHashKey;
+      } else {
         tree->pawn_score.key = PawnHashKey;
         tree->pawn_score.open_files = 255;
+        tree->pawn_score.filler = 0;
         tree->pawn_score.score_mg = 0;
         tree->pawn_score.score_eg = 0;
         for (side = black; side <= white; side++)
           EvaluatePawns(tree, side);
-        ptable->key =
-            pxtable->entry[0] ^ pxtable->entry[1] ^ pxtable->
-            entry[2] ^ pxtable->entry[3];
-        memcpy((char *) ptable + 8, (char *) &(tree->pawn_score) + 8, 24);
+        memcpy((char *) pawn_words, (char *) &(tree->pawn_score), 32);
+        pxtable->entry[1] = pawn_words[1];
+        pxtable->entry[2] = pawn_words[2];
+        pxtable->entry[3] = pawn_words[3];
+        pxtable->entry[0] =
+            pawn_words[0] ^ pawn_words[1] ^ pawn_words[2] ^ pawn_words[3];
       }
       tree->score_mg += tree->pawn_score.score_mg;
       tree->score_eg += tree->pawn_score.score_eg;
@@ -271,6 +336,7 @@ int Evaluate(TREE * RESTRICT tree, int ply, int wtm, int alpha, int beta) {
     }
     for (side = black; side <= white; side++)
       EvaluateKings(tree, ply, side);
+    full = 1;
   }
 #ifdef DEBUGEV
   printf("score[pieces]= (MG)                 %4d\n", score);
@@ -293,7 +359,26 @@ int Evaluate(TREE * RESTRICT tree, int ply, int wtm, int alpha, int beta) {
             skill) * PAWN_VALUE * (BITBOARD) Random32() / 0x100000000ull) /
         100;
 #endif
-  return ((wtm) ? score : -score);
+/*
+ **********************************************************************
+ *                                                                    *
+ *   Save the score in the evaluation hash table, but only if this    *
+ *   was a complete evaluation.  A lazy exit produced a score that    *
+ *   is only good enough for the current alpha/beta window, and it    *
+ *   can not be re-used with some other window.  The data and key     *
+ *   words are xor'ed together exactly as in HashStore().             *
+ *                                                                    *
+ **********************************************************************
+ */
+  score = (wtm) ? score : -score;
+  if (etable && full) {
+    word1 =
+        ((BITBOARD) transposition_age << 55) | ((BITBOARD) context << 17) |
+        (BITBOARD) (score + 65536);
+    etable->word1 = word1;
+    etable->word2 = temp_hashkey ^ word1;
+  }
+  return (score);
 }
 
 /* last modified 10/29/09 */
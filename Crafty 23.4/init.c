@@ -95,6 +95,8 @@ void Initialize() {
       sizeof(HPATH_ENTRY) * hash_path_size);
   AlignedMalloc((void **) &pawn_hash_table, 32,
       sizeof(PAWN_HASH_ENTRY) * pawn_hash_table_size);
+  AlignedMalloc((void **) &eval_hash_table, 64,
+      sizeof(HASH_ENTRY) * eval_hash_table_size);
   if (!trans_ref) {
     Print(128,
         "AlignedMalloc() failed, not enough memory (primary trans/ref table).\n");
@@ -107,6 +109,12 @@ void Initialize() {
     pawn_hash_table_size = 0;
     pawn_hash_table = 0;
   }
+  if (!eval_hash_table) {
+    Print(128,
+        "AlignedMalloc() failed, not enough memory (eval hash table).\n");
+    eval_hash_table_size = 0;
+    eval_hash_table = 0;
+  }
 /*
  ************************************************************
  *                                                          *
@@ -778,6 +786,7 @@ void InitializeHashTables(void) {
   int i, side;
 
   transposition_age = 0;
+  InitializeEvalHashTable();
   if (!trans_ref)
     return;
   for (i = 0; i < hash_table_size; i++) {
@@ -807,6 +816,27 @@ void InitializeHashTables(void) {
   }
 }
 
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   InitializeEvalHashTable() is used to clear the evaluation hash table.     *
+ *   Entries are tagged with the search age so that stale scores are normally  *
+ *   ignored anyway, but this is needed when the evaluation is displayed term  *
+ *   by term (the "score" command) or when a new game is started.              *
+ *                                                                             *
+ *******************************************************************************
+ */
+void InitializeEvalHashTable(void) {
+  int i;
+
+  if (!eval_hash_table)
+    return;
+  for (i = 0; i < eval_hash_table_size; i++) {
+    (eval_hash_table + i)->word1 = 0;
+    (eval_hash_table + i)->word2 = 0;
+  }
+}
+
 /*
  *******************************************************************************
  *                                                                             *
@@ -1149,6 +1179,7 @@ void InitializeSMP(void) {
   LockInit(lock_smp);
   LockInit(lock_io);
   LockInit(lock_root);
+  LockInit(perft_lock);
   LockInit(block[0]->lock);
 #if defined(UNIX) && (CPUS > 1)
   pthread_attr_init(&attributes);
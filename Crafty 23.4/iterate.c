@@ -83,6 +83,7 @@ int Iterate(int wtm, int search_type, int root_list_done) {
       transposition_age = (transposition_age + 1) & 0x1ff;
       next_time_check = nodes_between_time_checks;
       tree->evaluations = 0;
+      tree->eval_hash_hits = 0;
       tree->egtb_probes = 0;
       tree->egtb_probes_successful = 0;
       tree->extensions_done = 0;
@@ -539,8 +540,11 @@ int Iterate(int wtm, int search_type, int root_list_done) {
         Print(16, "qchecks=%s ", DisplayKM(tree->qchecks_done));
         Print(16, "reduced=%s ", DisplayKM(tree->reductions_done));
         Print(16, "pruned=%s\n", DisplayKM(tree->moves_pruned));
-        Print(16, "              predicted=%d  evals=%s  50move=%d",
-            predicted, DisplayKM(tree->evaluations), Rule50Moves(0));
+        Print(16, "              predicted=%d  evals=%s  ehits=%d%%",
+            predicted, DisplayKM(tree->evaluations),
+            (int) ((BITBOARD) tree->eval_hash_hits * 100 /
+                (BITBOARD) tree->evaluations));
+        Print(16, "  50move=%d", Rule50Moves(0));
         Print(16, "  EGTBprobes=%s  hits=%s\n", DisplayKM(tree->egtb_probes),
             DisplayKM(tree->egtb_probes_successful));
         Print(16, "              SMP->  splits=%d  aborts=%d  data=%d/%d  ",
@@ -1081,6 +1081,43 @@ int Option(TREE * RESTRICT tree) {
         PrintKM(pawn_hash_table_size * sizeof(PAWN_HASH_ENTRY), 1));
     Print(128, " (%s entries).\n", PrintKM(pawn_hash_table_size, 1));
   }
+/*
+ ************************************************************
+ *                                                          *
+ *   "ehash" command controls the evaluation hash table     *
+ *   size.  The size is entered just like the hash command  *
+ *   and is rounded down to a perfect power of 2 in the     *
+ *   same way.                                              *
+ *                                                          *
+ ************************************************************
+ */
+  else if (OptionMatch("ehash", *args)) {
+    size_t new_hash_size;
+
+    if (thinking || pondering)
+      return (2);
+    if (nargs > 1) {
+      new_hash_size = atoiKM(args[1]);
+      if (new_hash_size < 16 * 1024) {
+        printf("ERROR.  Minimum eval hash table size is 16K bytes.\n");
+        return (1);
+      }
+      eval_hash_table_size =
+          (1ull << MSB(new_hash_size)) / sizeof(HASH_ENTRY);
+      AlignedRemalloc((void **) &eval_hash_table, 64,
+          sizeof(HASH_ENTRY) * eval_hash_table_size);
+      if (!eval_hash_table) {
+        printf("AlignedRemalloc() failed, not enough memory.\n");
+        eval_hash_table_size = 0;
+        eval_hash_table = 0;
+      }
+      eval_hash_mask = (1ull << MSB((BITBOARD) eval_hash_table_size)) - 1;
+      InitializeEvalHashTable();
+    }
+    Print(128, "eval hash table memory = %s bytes",
+        PrintKM(eval_hash_table_size * sizeof(HASH_ENTRY), 1));
+    Print(128, " (%s entries).\n", PrintKM(eval_hash_table_size, 1));
+  }
 /*
  ************************************************************
  *                                                          *
@@ -2383,36 +2420,65 @@ int Option(TREE * RESTRICT tree) {
 /*
  ************************************************************
  *                                                          *
- *   "perft" command turns tests move generator/make_move.  *
+ *   "perft" command tests move generator/make_move.  The   *
+ *   syntax is "perft <depth> [threads]".  The root moves   *
+ *   are distributed over the threads (default is the mt=   *
+ *   setting) and the node count below each root move is    *
+ *   displayed (a "divide") so that a movgen bug can be     *
+ *   found by comparing against another program.  Subtree   *
+ *   counts are cached in the trans/ref table (so the hash= *
+ *   setting controls the size of this cache).  The table   *
+ *   is not cleared, since perft signatures are salted with *
+ *   the remaining depth and do not match search entries,   *
+ *   and a cached count stays valid for later perft runs.   *
  *                                                          *
  ************************************************************
  */
   else if (OptionMatch("perft", *args)) {
-    int i, clock_before, clock_after;
-    float time_used;
+    int i, depth, threads = 1;
+    unsigned int start_time, elapsed;
+    BITBOARD generated = 0, made = 0, gen_time = 0, make_time = 0, hits = 0;
 
     if (thinking || pondering)
       return (2);
-    clock_before = clock();
-    while (clock() == clock_before);
-    clock_before = clock();
     if (nargs < 2) {
-      printf("usage:  perftest <depth>\n");
+      printf("usage:  perft <depth> [threads]\n");
       return (1);
     }
+    depth = atoi(args[1]);
+    if (depth <= 0 || depth > MAXPLY - 5) {
+      Print(128, "usage:  perft <depth> [threads]\n");
+      return (1);
+    }
+#if (CPUS > 1)
+    threads = (nargs > 2) ? atoi(args[2]) : Max(smp_max_threads, 1);
+    threads = Max(1, Min(threads, CPUS));
+#endif
     tree->position[1] = tree->position[0];
     tree->last[0] = tree->move_list;
-    i = atoi(args[1]);
-    if (i <= 0) {
-      Print(128, "usage:  perft <maxply>\n");
-      return (1);
+    start_time = ReadClock();
+    total_moves = OptionPerftRoot(tree, depth, wtm, threads);
+    elapsed = Max(ReadClock() - start_time, 1);
+    for (i = 0; i < perft_root_count; i++)
+      Print(128, "%-8s " BMF "\n", OutputMove(tree, perft_root_moves[i], 1,
+              wtm), perft_root_nodes[i]);
+    for (i = 0; i < threads; i++) {
+      generated += perft_stats[i].generated;
+      made += perft_stats[i].made;
+      gen_time += perft_stats[i].gen_time;
+      make_time += perft_stats[i].make_time;
+      hits += perft_stats[i].hits;
+    }
+    Print(128, "total moves=" BMF "  time=%s  threads=%d  hash hits=" BMF
+        "\n", total_moves, DisplayTimeKibitz(elapsed), threads, hits);
+    Print(128, "nodes per second=%s\n",
+        DisplayKM(total_moves * 100 / elapsed));
+    if (gen_time && make_time) {
+      Print(128, "generated per second=%s",
+          DisplayKM(generated * 1000000 * threads / gen_time));
+      Print(128, "  made/unmade per second=%s\n",
+          DisplayKM(made * 1000000 * threads / make_time));
     }
-    total_moves = 0;
-    OptionPerft(tree, 1, i, wtm);
-    clock_after = clock();
-    time_used =
-        ((float) clock_after - (float) clock_before) / (float) CLOCKS_PER_SEC;
-    printf("total moves=" BMF "  time=%.2f\n", total_moves, time_used);
   }
 /*
  ************************************************************
@@ -3207,6 +3273,7 @@ int Option(TREE * RESTRICT tree) {
     Print(128, "    comp     mg      eg   |\n");
     root_wtm = Flip(wtm);
     tree->position[1] = tree->position[0];
+    InitializeEvalHashTable();
     s = Evaluate(tree, 1, wtm, -99999, 99999);
     if (!wtm)
       s = -s;
@@ -4005,38 +4072,233 @@ int OptionMatch(char *command, char *input) {
     return (1);
   return (0);
 }
-void OptionPerft(TREE * RESTRICT tree, int ply, int depth, int wtm) {
-  int *mv;
-  static char line[256];
-#if defined(TRACE)
-  static char move[16], *p[64];
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   OptionPerftRoot() is the driver for the perft command.  It generates the  *
+ *   legal root moves and then hands them out, one at a time, to "threads"     *
+ *   threads which each search the sub-tree below that root move using their   *
+ *   own private copy of the tree.  The per-move node counts are left in       *
+ *   perft_root_nodes[] so that the caller can display the divide.            *
+ *                                                                             *
+ *******************************************************************************
+ */
+BITBOARD OptionPerftRoot(TREE * RESTRICT tree, int depth, int wtm,
+    int threads) {
+  BITBOARD total = 0;
+  int *mv, i;
+#if (CPUS > 1)
+  long proc;
+  pthread_t pt;
 #endif
-  tree->last[ply] = GenerateCaptures(tree, ply, wtm, tree->last[ply - 1]);
-  for (mv = tree->last[ply - 1]; mv < tree->last[ply]; mv++)
-    if (Captured(*mv) == king)
-      return;
-  tree->last[ply] = GenerateNoncaptures(tree, ply, wtm, tree->last[ply]);
-#if defined(TRACE)
-  p[1] = line;
+
+  tree->last[1] = GenerateCaptures(tree, 1, wtm, tree->last[0]);
+  tree->last[1] = GenerateNoncaptures(tree, 1, wtm, tree->last[1]);
+  perft_root_count = 0;
+  for (mv = tree->last[0]; mv < tree->last[1]; mv++) {
+    MakeMove(tree, 1, *mv, wtm);
+    if (!Check(wtm)) {
+      perft_root_moves[perft_root_count] = *mv;
+      perft_root_nodes[perft_root_count++] = 0;
+    }
+    UnmakeMove(tree, 1, *mv, wtm);
+  }
+  for (i = 0; i < CPUS; i++) {
+    perft_stats[i].generated = 0;
+    perft_stats[i].made = 0;
+    perft_stats[i].gen_time = 0;
+    perft_stats[i].make_time = 0;
+    perft_stats[i].hits = 0;
+  }
+  perft_tree = tree;
+  perft_depth = depth;
+  perft_wtm = wtm;
+  perft_next_root = 0;
+  perft_threads_done = 0;
+#if (CPUS > 1)
+  for (proc = 1; proc < threads; proc++) {
+#  if defined(_WIN32) || defined(_WIN64)
+    NumaStartThread(OptionPerftThread, (void *) proc);
+#  else
+    pthread_create(&pt, &attributes, OptionPerftThread, (void *) proc);
+#  endif
+  }
 #endif
-  for (mv = tree->last[ply - 1]; mv < tree->last[ply]; mv++) {
-#if defined(TRACE)
-    strcpy(move, OutputMove(tree, *mv, ply, wtm));
+  OptionPerftThread((void *) 0);
+  while (perft_threads_done < threads);
+  for (i = 0; i < perft_root_count; i++)
+    total += perft_root_nodes[i];
+  return (total);
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   OptionPerftThread() is run by each perft thread.  It builds a private     *
+ *   tree from the root position, then repeatedly grabs the next unsearched    *
+ *   root move and counts the nodes below it with OptionPerft().               *
+ *                                                                             *
+ *******************************************************************************
+ */
+void *STDCALL OptionPerftThread(void *tid) {
+  TREE *tree;
+  int root, move;
+
+  tree = (TREE *) malloc(sizeof(TREE));
+  if (!tree) {
+    Print(4095, "ERROR.  perft thread %d can not allocate a tree\n",
+        (int) (long) tid);
+    exit(1);
+  }
+  tree->pos = perft_tree->pos;
+  tree->position[1] = perft_tree->position[1];
+  tree->last[1] = tree->move_list;
+  while (1) {
+#if (CPUS > 1)
+    Lock(perft_lock);
 #endif
-    MakeMove(tree, ply, *mv, wtm);
-#if defined(TRACE)
-    if (ply <= trace_level) {
-      strcpy(p[ply], move);
-      strcpy(line + strlen(line), " ");
-      p[ply + 1] = line + strlen(line);
-      if (ply == trace_level)
-        printf("%s\n", line);
-    }
+    root = perft_next_root++;
+#if (CPUS > 1)
+    Unlock(perft_lock);
+#endif
+    if (root >= perft_root_count)
+      break;
+    move = perft_root_moves[root];
+    MakeMove(tree, 1, move, perft_wtm);
+    perft_root_nodes[root] =
+        (perft_depth > 1) ? OptionPerft(tree, 2, perft_depth - 1,
+        Flip(perft_wtm), &perft_stats[(long) tid]) : 1;
+    UnmakeMove(tree, 1, move, perft_wtm);
+  }
+  free(tree);
+#if (CPUS > 1)
+  Lock(perft_lock);
+#endif
+  perft_threads_done++;
+#if (CPUS > 1)
+  Unlock(perft_lock);
 #endif
-    if (depth - 1)
-      OptionPerft(tree, ply + 1, depth - 1, Flip(wtm));
-    else if (!Check(wtm))
-      total_moves++;
-    UnmakeMove(tree, ply, *mv, wtm);
+  return (0);
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   OptionPerft() counts the legal move paths of length "depth" from the      *
+ *   current position.  Node counts for sub-trees of depth 2 or more are       *
+ *   saved in the trans/ref table, using the lockless xor trick described in   *
+ *   HashProbe(), since the table is shared by all of the perft threads.  The  *
+ *   signature includes the remaining depth, and the 64 bit data word holds    *
+ *   the depth in the upper 8 bits and the node count in the lower 56 bits,    *
+ *   which lets the replacement policy keep the deepest (most valuable)        *
+ *   sub-tree counts.                                                          *
+ *                                                                             *
+ *   The frontier (depth=1) nodes do nearly all of the work, so this is where  *
+ *   the time spent generating moves and the time spent making/unmaking them   *
+ *   is measured, to compute separate per-second figures for each.  Reading    *
+ *   the clock around every frontier node would cost more than the node        *
+ *   itself, so a depth=2 node times all of its frontier nodes as a batch.     *
+ *   It first makes each move and generates the frontier moves into the move   *
+ *   list behind its own moves, then it makes each move again and makes and    *
+ *   unmakes the stored frontier moves.  The first pass is charged to move     *
+ *   generation, the second to make/unmake.                                    *
+ *                                                                             *
+ *******************************************************************************
+ */
+BITBOARD OptionPerft(TREE * RESTRICT tree, int ply, int depth, int wtm,
+    PERFT_STATS * stats) {
+  HASH_ENTRY *htable = 0, *replace;
+  BITBOARD word1, temp_hashkey = 0, nodes = 0, start, now;
+  int *mv, *fmv, *first[257], moves[256], entry, i, n;
+
+  if (depth > 1 && trans_ref) {
+    temp_hashkey =
+        ((wtm) ? HashKey : ~HashKey) ^ ((BITBOARD) depth *
+        0x9e3779b97f4a7c15ull);
+    htable = trans_ref + 4 * (temp_hashkey & hash_mask);
+    for (entry = 0; entry < 4; entry++) {
+      word1 = htable[entry].word1;
+      if ((word1 ^ htable[entry].word2) == temp_hashkey) {
+        stats->hits++;
+        return (word1 & 0x00ffffffffffffffull);
+      }
+    }
+  }
+  tree->last[ply] = GenerateCaptures(tree, ply, wtm, tree->last[ply - 1]);
+  tree->last[ply] = GenerateNoncaptures(tree, ply, wtm, tree->last[ply]);
+  if (depth == 1) {
+    for (mv = tree->last[ply - 1]; mv < tree->last[ply]; mv++) {
+      MakeMove(tree, ply, *mv, wtm);
+      if (!Check(wtm))
+        nodes++;
+      UnmakeMove(tree, ply, *mv, wtm);
+    }
+    return (nodes);
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *   At depth=2 the frontier nodes are done in batches, as  *
+ *   many as fit in the rest of the move list.  Each batch  *
+ *   first generates the frontier moves below every legal   *
+ *   move, then goes back and makes/unmakes them, so that   *
+ *   the clock is read twice per batch rather than twice    *
+ *   per frontier node.                                     *
+ *                                                          *
+ ************************************************************
+ */
+  if (depth == 2) {
+    mv = tree->last[ply - 1];
+    while (mv < tree->last[ply]) {
+      start = ReadClockMicro();
+      fmv = tree->last[ply];
+      for (n = 0; mv < tree->last[ply] && (n == 0 ||
+              fmv + 256 <= tree->move_list + 5120); mv++) {
+        MakeMove(tree, ply, *mv, wtm);
+        if (!Check(wtm)) {
+          moves[n] = *mv;
+          first[n++] = fmv;
+          fmv = GenerateCaptures(tree, ply + 1, Flip(wtm), fmv);
+          fmv = GenerateNoncaptures(tree, ply + 1, Flip(wtm), fmv);
+        }
+        UnmakeMove(tree, ply, *mv, wtm);
+      }
+      first[n] = fmv;
+      stats->generated += fmv - tree->last[ply];
+      stats->made += fmv - tree->last[ply];
+      now = ReadClockMicro();
+      stats->gen_time += now - start;
+      start = now;
+      for (i = 0; i < n; i++) {
+        MakeMove(tree, ply, moves[i], wtm);
+        for (fmv = first[i]; fmv < first[i + 1]; fmv++) {
+          MakeMove(tree, ply + 1, *fmv, Flip(wtm));
+          if (!Check(Flip(wtm)))
+            nodes++;
+          UnmakeMove(tree, ply + 1, *fmv, Flip(wtm));
+        }
+        UnmakeMove(tree, ply, moves[i], wtm);
+      }
+      stats->make_time += ReadClockMicro() - start;
+    }
+  } else
+    for (mv = tree->last[ply - 1]; mv < tree->last[ply]; mv++) {
+      MakeMove(tree, ply, *mv, wtm);
+      if (!Check(wtm))
+        nodes += OptionPerft(tree, ply + 1, depth - 1, Flip(wtm), stats);
+      UnmakeMove(tree, ply, *mv, wtm);
+    }
+  if (htable) {
+    replace = htable;
+    for (entry = 1; entry < 4; entry++)
+      if ((htable[entry].word1 >> 56) < (replace->word1 >> 56))
+        replace = htable + entry;
+    word1 = ((BITBOARD) depth << 56) | nodes;
+    replace->word1 = word1;
+    replace->word2 = temp_hashkey ^ word1;
   }
+  return (nodes);
 }
@@ -153,6 +153,7 @@ void CopyFromChild(TREE * RESTRICT p, TREE * RESTRICT c, int value) {
   p->fail_high += c->fail_high;
   p->fail_high_first += c->fail_high_first;
   p->evaluations += c->evaluations;
+  p->eval_hash_hits += c->eval_hash_hits;
   p->egtb_probes += c->egtb_probes;
   p->egtb_probes_successful += c->egtb_probes_successful;
   p->extensions_done += c->extensions_done;
@@ -229,6 +230,7 @@ TREE *CopyToChild(TREE * RESTRICT p, int thread) {
   c->fail_high = 0;
   c->fail_high_first = 0;
   c->evaluations = 0;
+  c->eval_hash_hits = 0;
   c->egtb_probes = 0;
   c->egtb_probes_successful = 0;
   c->extensions_done = 0;
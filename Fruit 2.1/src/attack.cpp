@@ -4,6 +4,7 @@
 // includes
 
 #include "attack.h"
+#include "bitboard.h"
 #include "board.h"
 #include "colour.h"
 #include "move.h"
@@ -13,6 +14,8 @@
 
 // variables
 
+bool UseBitboard = true; // "Bitboard Attacks" UCI option, false => ray walkers
+
 int DeltaIncLine[DeltaNb];
 int DeltaIncAll[DeltaNb];
 
@@ -26,7 +29,12 @@ static int PieceDeltaDelta[4][256][4]; // 16 kB
 
 // prototypes
 
-static void add_attack (int piece, int king, int target);
+static void add_attack         (int piece, int king, int target);
+
+static bool is_attacked_ray    (const board_t * board, int to, int colour);
+static bool line_is_empty_ray  (const board_t * board, int from, int to);
+static bool is_pinned_ray      (const board_t * board, int square, int colour);
+static bool is_pinned_bb       (const board_t * board, int square, int colour);
 
 // functions
 
@@ -244,6 +252,45 @@ static void add_attack(int piece, int king, int target) {
 
 bool is_attacked(const board_t * board, int to, int colour) {
 
+   ASSERT(board!=NULL);
+   ASSERT(SQUARE_IS_OK(to));
+   ASSERT(COLOUR_IS_OK(colour));
+
+   if (UseBitboard) {
+      ASSERT((attackers_to(board,to,colour)!=0)==is_attacked_ray(board,to,colour));
+      return attackers_to(board,to,colour) != 0;
+   }
+
+   return is_attacked_ray(board,to,colour);
+}
+
+// attackers_to()
+
+uint64 attackers_to(const board_t * board, int to, int colour) {
+
+   int sq_64;
+   uint64 occ;
+
+   ASSERT(board!=NULL);
+   ASSERT(SQUARE_IS_OK(to));
+   ASSERT(COLOUR_IS_OK(colour));
+
+   // pieces of "colour" attacking "to" (12-indexed pieces alternate colours)
+
+   sq_64 = SQUARE_TO_64(to);
+   occ = BOARD_OCC(board);
+
+   return (PawnAttack[COLOUR_OPP(colour)][sq_64] & BOARD_BB(board,WhitePawn12+colour))
+        | (KnightAttack[sq_64] & BOARD_BB(board,WhiteKnight12+colour))
+        | (KingAttack[sq_64] & BOARD_BB(board,WhiteKing12+colour))
+        | (BISHOP_ATTACK(sq_64,occ) & (BOARD_BB(board,WhiteBishop12+colour) | BOARD_BB(board,WhiteQueen12+colour)))
+        | (ROOK_ATTACK(sq_64,occ) & (BOARD_BB(board,WhiteRook12+colour) | BOARD_BB(board,WhiteQueen12+colour)));
+}
+
+// is_attacked_ray()
+
+static bool is_attacked_ray(const board_t * board, int to, int colour) {
+
    int inc;
    int pawn;
    const sq_t * ptr;
@@ -291,6 +338,22 @@ bool is_attacked(const board_t * board, int to, int colour) {
 
 bool line_is_empty(const board_t * board, int from, int to) {
 
+   ASSERT(board!=NULL);
+   ASSERT(SQUARE_IS_OK(from));
+   ASSERT(SQUARE_IS_OK(to));
+
+   if (UseBitboard) {
+      ASSERT(((BETWEEN(SQUARE_TO_64(from),SQUARE_TO_64(to))&BOARD_OCC(board))==0)==line_is_empty_ray(board,from,to));
+      return (BETWEEN(SQUARE_TO_64(from),SQUARE_TO_64(to)) & BOARD_OCC(board)) == 0;
+   }
+
+   return line_is_empty_ray(board,from,to);
+}
+
+// line_is_empty_ray()
+
+static bool line_is_empty_ray(const board_t * board, int from, int to) {
+
    int delta;
    int inc, sq;
 
@@ -317,6 +380,62 @@ bool line_is_empty(const board_t * board, int from, int to) {
 
 bool is_pinned(const board_t * board, int square, int colour) {
 
+   ASSERT(board!=NULL);
+   ASSERT(SQUARE_IS_OK(square));
+   ASSERT(COLOUR_IS_OK(colour));
+
+   if (UseBitboard) {
+      ASSERT(is_pinned_bb(board,square,colour)==is_pinned_ray(board,square,colour));
+      return is_pinned_bb(board,square,colour);
+   }
+
+   return is_pinned_ray(board,square,colour);
+}
+
+// is_pinned_bb()
+
+static bool is_pinned_bb(const board_t * board, int square, int colour) {
+
+   int opp;
+   int inc;
+   int sq_64, king_64;
+   uint64 occ, sliders;
+
+   ASSERT(board!=NULL);
+   ASSERT(SQUARE_IS_OK(square));
+   ASSERT(COLOUR_IS_OK(colour));
+
+   inc = DELTA_INC_LINE(KING_POS(board,colour)-square);
+   if (inc == IncNone) return false; // not a line
+
+   sq_64 = SQUARE_TO_64(square);
+   king_64 = SQUARE_TO_64(KING_POS(board,colour));
+
+   occ = BOARD_OCC(board);
+   if ((BETWEEN(sq_64,king_64) & occ) != 0) return false; // blocker
+
+   // sliders seen from the king through "square"
+
+   opp = COLOUR_OPP(colour);
+   occ &= ~BB_BIT(sq_64);
+
+   if ((INC_MASK(inc) & RookFlag) != 0) {
+      sliders = ROOK_ATTACK(king_64,occ) & (BOARD_BB(board,WhiteRook12+opp) | BOARD_BB(board,WhiteQueen12+opp));
+   } else {
+      sliders = BISHOP_ATTACK(king_64,occ) & (BOARD_BB(board,WhiteBishop12+opp) | BOARD_BB(board,WhiteQueen12+opp));
+   }
+
+   for (; sliders != 0; sliders &= sliders - 1) {
+      if ((BETWEEN(king_64,bb_first(sliders)) & BB_BIT(sq_64)) != 0) return true;
+   }
+
+   return false;
+}
+
+// is_pinned_ray()
+
+static bool is_pinned_ray(const board_t * board, int square, int colour) {
+
    int from, to;
    int inc;
    int sq, piece;
@@ -392,6 +511,14 @@ void attack_set(attack_t * attack, const board_t * board) {
 
    to = KING_POS(board,me);
 
+   // not in check (the common case)
+
+   if (UseBitboard && attackers_to(board,to,opp) == 0) {
+      attack->ds[0] = SquareNone;
+      attack->di[0] = IncNone;
+      return;
+   }
+
    // pawn attacks
 
    inc = PAWN_MOVE_INC(opp);
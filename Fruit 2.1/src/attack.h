@@ -36,6 +36,8 @@ struct attack_t {
 
 // variables
 
+extern bool UseBitboard;
+
 extern int DeltaIncLine[DeltaNb];
 extern int DeltaIncAll[DeltaNb];
 
@@ -44,18 +46,19 @@ extern int IncMask[IncNb];
 
 // functions
 
-extern void attack_init   ();
+extern void   attack_init   ();
 
-extern bool is_attacked   (const board_t * board, int to, int colour);
+extern bool   is_attacked   (const board_t * board, int to, int colour);
+extern uint64 attackers_to  (const board_t * board, int to, int colour);
 
-extern bool line_is_empty (const board_t * board, int from, int to);
+extern bool   line_is_empty (const board_t * board, int from, int to);
 
-extern bool is_pinned     (const board_t * board, int square, int colour);
+extern bool   is_pinned     (const board_t * board, int square, int colour);
 
-extern bool attack_is_ok  (const attack_t * attack);
-extern void attack_set    (attack_t * attack, const board_t * board);
+extern bool   attack_is_ok  (const attack_t * attack);
+extern void   attack_set    (attack_t * attack, const board_t * board);
 
-extern bool piece_attack_king (const board_t * board, int piece, int from, int king);
+extern bool   piece_attack_king (const board_t * board, int piece, int from, int king);
 
 #endif // !defined ATTACK_H
 
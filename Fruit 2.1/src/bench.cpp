@@ -0,0 +1,559 @@
+
+// bench.cpp
+
+// includes
+
+#include <cstdio>
+#include <cstring>
+
+#include "attack.h"
+#include "bench.h"
+#include "board.h"
+#include "eval.h"
+#include "fen.h"
+#include "hash.h"
+#include "list.h"
+#include "move.h"
+#include "move_do.h"
+#include "move_gen.h"
+#include "option.h"
+#include "posix.h"
+#include "protocol.h"
+#include "search.h"
+#include "trans.h"
+#include "util.h"
+
+// constants
+
+static const char * const BenchFen[] = {
+   "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+   "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+   "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+   "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+   "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+   "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+   "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+   "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+   "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+   "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/3N4 b - - 0 1",
+   "2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+   "8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+   NULL,
+};
+
+static const int BenchFenNb = sizeof(BenchFen) / sizeof(BenchFen[0]) - 1;
+
+static const int PerftHashDepth = 2; // depth-1 nodes are bulk counted
+
+// types
+
+struct bench_t {
+   sint64 node_nb;
+   double time;
+};
+
+struct perft_entry_t {
+   uint64 check; // key ^ data, detects entries torn by concurrent writes
+   uint64 data; // node_nb << 8 | depth
+};
+
+struct perft_t {
+   perft_entry_t * table;
+   uint64 mask;
+   const board_t * board;
+   list_t list[1];
+   int depth;
+   int thread_nb;
+   sint64 node_nb[ListSize]; // per root move
+};
+
+// variables
+
+static perft_t Perft[1];
+
+static board_t PerftBoard[ThreadMax];
+static my_thread_t PerftThread[ThreadMax];
+
+// prototypes
+
+static void   bench_run       (bench_t * bench, int depth, bench_t position[]);
+static void   bench_perft_all (bench_t * bench, int depth);
+static double bench_eval_run  (int round_nb, bool generic, sint64 * eval_nb, sint64 * check);
+
+static void   perft_thread    (int id);
+static sint64 perft           (board_t * board, int depth, bool hash);
+
+static bool   perft_probe     (uint64 key, int depth, sint64 * node_nb);
+static void   perft_store     (uint64 key, int depth, sint64 node_nb);
+
+// functions
+
+// bench_search()
+
+void bench_search(int depth) {
+
+   char * old_book;
+   bench_t bench[1];
+   bench_t position[BenchFenNb];
+   char json[65536];
+   char * ptr;
+   int i;
+
+   ASSERT(depth>=1&&depth<DepthMax);
+
+   old_book = my_strdup(option_get("OwnBook"));
+
+   option_set("OwnBook","false");
+
+   bench_run(bench,depth,position);
+
+   send("info string bench depth %d threads %d nodes " S64_FORMAT " time %.0f nps %.0f",
+        depth,option_get_int("Threads"),bench->node_nb,bench->time*1000.0,
+        (bench->time > 0.0) ? double(bench->node_nb) / bench->time : 0.0);
+
+   // JSON (one line)
+
+   ptr = json;
+   ptr += sprintf(ptr,"{\"command\":\"bench\",\"depth\":%d,\"threads\":%d,\"hash\":%d,\"positions\":[",
+                  depth,option_get_int("Threads"),option_get_int("Hash"));
+
+   for (i = 0; i < BenchFenNb; i++) {
+      ptr += sprintf(ptr,"%s{\"fen\":\"%s\",\"nodes\":" S64_FORMAT ",\"time_ms\":%.0f}",
+                     (i == 0) ? "" : ",",BenchFen[i],position[i].node_nb,position[i].time*1000.0);
+   }
+
+   ptr += sprintf(ptr,"],\"nodes\":" S64_FORMAT ",\"time_ms\":%.0f,\"nps\":%.0f}",
+                  bench->node_nb,bench->time*1000.0,(bench->time > 0.0) ? double(bench->node_nb) / bench->time : 0.0);
+
+   ASSERT(ptr-json<int(sizeof(json)));
+
+   send("%s",json);
+
+   option_set("OwnBook",old_book);
+   my_free(old_book);
+}
+
+// bench_perft()
+
+void bench_perft(const board_t * board, int depth, int thread_nb, bool divide) {
+
+   bool is_large;
+   uint64 size, target;
+   my_timer_t timer[1];
+   sint64 node_nb;
+   double time;
+   char fen[256];
+   char move_string[256];
+   char json[65536];
+   char * ptr;
+   int i;
+
+   ASSERT(board!=NULL);
+   ASSERT(depth>=1);
+   ASSERT(thread_nb>=1&&thread_nb<=ThreadMax);
+   ASSERT(divide==true||divide==false);
+
+   // hash table, takes over the memory of the transposition table while counting
+
+   trans_free(Trans);
+
+   target = uint64(option_get_int("Hash")) * 1024 * 1024 / sizeof(perft_entry_t);
+   for (size = 1; size * 2 <= target; size *= 2)
+      ;
+
+   Perft->table = (perft_entry_t *) my_aligned_alloc(size*sizeof(perft_entry_t),option_get_bool("Large Pages"),&is_large);
+   memset(Perft->table,0,size_t(size*sizeof(perft_entry_t)));
+   Perft->mask = size - 1;
+
+   // root moves
+
+   board_copy(&PerftBoard[0],board);
+   gen_legal_moves(Perft->list,&PerftBoard[0]);
+
+   Perft->board = board;
+   Perft->depth = depth;
+   Perft->thread_nb = thread_nb;
+
+   if (Perft->thread_nb > LIST_SIZE(Perft->list)) Perft->thread_nb = LIST_SIZE(Perft->list);
+   if (Perft->thread_nb < 1) Perft->thread_nb = 1;
+
+   // count, root moves are dealt out round-robin
+
+   my_timer_reset(timer);
+   my_timer_start(timer);
+
+   for (i = 1; i < Perft->thread_nb; i++) my_thread_create(&PerftThread[i],perft_thread,i);
+   perft_thread(0);
+   for (i = 1; i < Perft->thread_nb; i++) my_thread_join(&PerftThread[i]);
+
+   my_timer_stop(timer);
+
+   my_aligned_free(Perft->table);
+   Perft->table = NULL;
+
+   trans_alloc(Trans); // cleared
+
+   time = my_timer_elapsed_real(timer);
+
+   node_nb = 0;
+   for (i = 0; i < LIST_SIZE(Perft->list); i++) node_nb += Perft->node_nb[i];
+
+   // report
+
+   if (!board_to_fen(board,fen,256)) ASSERT(false);
+
+   ptr = json;
+   ptr += sprintf(ptr,"{\"command\":\"%s\",\"fen\":\"%s\",\"depth\":%d,\"threads\":%d",
+                  (divide) ? "divide" : "perft",fen,depth,thread_nb);
+
+   if (divide) {
+
+      ptr += sprintf(ptr,",\"moves\":{");
+
+      for (i = 0; i < LIST_SIZE(Perft->list); i++) {
+         move_to_string(LIST_MOVE(Perft->list,i),move_string,256);
+         send("info string %s " S64_FORMAT,move_string,Perft->node_nb[i]);
+         ptr += sprintf(ptr,"%s\"%s\":" S64_FORMAT,(i == 0) ? "" : ",",move_string,Perft->node_nb[i]);
+      }
+
+      ptr += sprintf(ptr,"}");
+   }
+
+   ptr += sprintf(ptr,",\"nodes\":" S64_FORMAT ",\"time_ms\":%.0f,\"nps\":%.0f}",
+                  node_nb,time*1000.0,(time > 0.0) ? double(node_nb) / time : 0.0);
+
+   ASSERT(ptr-json<int(sizeof(json)));
+
+   send("info string perft depth %d nodes " S64_FORMAT " time %.0f nps %.0f",
+        depth,node_nb,time*1000.0,(time > 0.0) ? double(node_nb) / time : 0.0);
+
+   send("%s",json);
+}
+
+// bench_smp()
+
+void bench_smp(int depth, const int thread_nb[], int size) {
+
+   char * old_threads;
+   char * old_book;
+   char string[256];
+   bench_t bench[1];
+   double base_time;
+   int i;
+
+   ASSERT(depth>=1&&depth<DepthMax);
+   ASSERT(thread_nb!=NULL);
+   ASSERT(size>0);
+
+   old_threads = my_strdup(option_get("Threads"));
+   old_book = my_strdup(option_get("OwnBook"));
+
+   option_set("OwnBook","false");
+
+   base_time = 0.0;
+
+   for (i = 0; i < size; i++) {
+
+      sprintf(string,"%d",thread_nb[i]);
+      option_set("Threads",string);
+
+      bench_run(bench,depth,NULL);
+
+      if (i == 0) base_time = bench->time;
+
+      send("info string threads %d depth %d time %.0f nodes " S64_FORMAT " nps %.0f speedup %.2f",
+           thread_nb[i],depth,bench->time*1000.0,bench->node_nb,
+           (bench->time > 0.0) ? double(bench->node_nb) / bench->time : 0.0,
+           (bench->time > 0.0) ? base_time / bench->time : 0.0);
+   }
+
+   option_set("Threads",old_threads);
+   option_set("OwnBook",old_book);
+
+   my_free(old_threads);
+   my_free(old_book);
+}
+
+// bench_bitboard()
+
+void bench_bitboard(int depth, int perft_depth) {
+
+   bool old_mode;
+   char * old_book;
+   bench_t search[2], leaf[2];
+   int mode;
+
+   ASSERT(depth>=1&&depth<DepthMax);
+   ASSERT(perft_depth>=1);
+
+   old_mode = UseBitboard;
+   old_book = my_strdup(option_get("OwnBook"));
+
+   option_set("OwnBook","false");
+
+   for (mode = 0; mode < 2; mode++) { // 0 = ray walkers, 1 = bitboards
+
+      UseBitboard = (mode == 1);
+
+      bench_run(&search[mode],depth,NULL);
+      bench_perft_all(&leaf[mode],perft_depth);
+
+      send("info string attacks %s search depth %d nodes " S64_FORMAT " nps %.0f perft depth %d leaves " S64_FORMAT " lps %.0f",
+           (mode == 1) ? "bitboard" : "rays",
+           depth,search[mode].node_nb,(search[mode].time > 0.0) ? double(search[mode].node_nb) / search[mode].time : 0.0,
+           perft_depth,leaf[mode].node_nb,(leaf[mode].time > 0.0) ? double(leaf[mode].node_nb) / leaf[mode].time : 0.0);
+   }
+
+   send("info string bitboard speedup search %.2f perft %.2f%s",
+        (search[1].time > 0.0) ? search[0].time / search[1].time : 0.0,
+        (leaf[1].time > 0.0) ? leaf[0].time / leaf[1].time : 0.0,
+        (search[0].node_nb != search[1].node_nb || leaf[0].node_nb != leaf[1].node_nb) ? " NODE COUNT MISMATCH" : "");
+
+   UseBitboard = old_mode;
+
+   option_set("OwnBook",old_book);
+   my_free(old_book);
+}
+
+// bench_eval()
+
+void bench_eval(int round_nb) {
+
+   sint64 eval_nb[2], check[2];
+   double time[2];
+   int mode;
+
+   ASSERT(round_nb>=1);
+
+   bench_eval_run(1,true,&eval_nb[0],&check[0]); // warm up the pawn and material tables
+
+   for (mode = 0; mode < 2; mode++) { // 0 = generic, 1 = default weights
+
+      time[mode] = bench_eval_run(round_nb,mode==0,&eval_nb[mode],&check[mode]);
+
+      send("info string eval %s calls " S64_FORMAT " time %.0f eps %.0f checksum " S64_FORMAT,
+           (mode == 1) ? "default" : "generic",eval_nb[mode],time[mode]*1000.0,
+           (time[mode] > 0.0) ? double(eval_nb[mode]) / time[mode] : 0.0,check[mode]);
+   }
+
+   send("info string eval default-weight speedup %.2f%s",
+        (time[1] > 0.0) ? time[0] / time[1] : 0.0,
+        (check[0] != check[1]) ? " (checksums differ: weights are not at 100%)" : "");
+}
+
+// bench_eval_run()
+
+static double bench_eval_run(int round_nb, bool generic, sint64 * eval_nb, sint64 * check) {
+
+   board_t board[1];
+   list_t list[1];
+   undo_t undo[1];
+   my_timer_t timer[1];
+   int i, j, round;
+   int move;
+
+   ASSERT(round_nb>=1);
+   ASSERT(eval_nb!=NULL);
+   ASSERT(check!=NULL);
+
+   // eval() on the bench positions and their children, without the eval cache
+
+   *eval_nb = 0;
+   *check = 0;
+
+   my_timer_reset(timer);
+   my_timer_start(timer);
+
+   for (i = 0; BenchFen[i] != NULL; i++) {
+
+      board_from_fen(board,BenchFen[i]);
+      gen_legal_moves(list,board);
+
+      for (j = 0; j < LIST_SIZE(list); j++) {
+
+         move = LIST_MOVE(list,j);
+         move_do(board,move,undo);
+
+         if (!board_is_check(board)) {
+            for (round = 0; round < round_nb; round++) {
+               *check += eval_uncached(board,generic);
+            }
+            *eval_nb += round_nb;
+         }
+
+         move_undo(board,move,undo);
+      }
+   }
+
+   my_timer_stop(timer);
+
+   return my_timer_elapsed_real(timer);
+}
+
+// bench_run()
+
+static void bench_run(bench_t * bench, int depth, bench_t position[]) {
+
+   int i;
+
+   ASSERT(bench!=NULL);
+   ASSERT(depth>=1&&depth<DepthMax);
+
+   bench->node_nb = 0;
+   bench->time = 0.0;
+
+   for (i = 0; BenchFen[i] != NULL; i++) {
+
+      // fixed-depth search from an empty transposition table
+
+      search_clear();
+
+      board_from_fen(SearchInput->board,BenchFen[i]);
+
+      SearchInput->depth_is_limited = true;
+      SearchInput->depth_limit = depth;
+      SearchInput->display = false;
+
+      trans_clear(Trans);
+
+      search();
+      search_update_current();
+
+      bench->node_nb += SearchCurrent->node_nb;
+      bench->time += SearchCurrent->time;
+
+      if (position != NULL) {
+         position[i].node_nb = SearchCurrent->node_nb;
+         position[i].time = SearchCurrent->time;
+      }
+   }
+}
+
+// bench_perft_all()
+
+static void bench_perft_all(bench_t * bench, int depth) {
+
+   board_t board[1];
+   my_timer_t timer[1];
+   int i;
+
+   ASSERT(bench!=NULL);
+   ASSERT(depth>=1);
+
+   my_timer_reset(timer);
+   my_timer_start(timer);
+
+   bench->node_nb = 0;
+
+   for (i = 0; BenchFen[i] != NULL; i++) {
+      board_from_fen(board,BenchFen[i]);
+      bench->node_nb += perft(board,depth,false);
+   }
+
+   my_timer_stop(timer);
+
+   bench->time = my_timer_elapsed_real(timer);
+}
+
+// perft_thread()
+
+static void perft_thread(int id) {
+
+   board_t * board;
+   undo_t undo[1];
+   int i, move;
+
+   ASSERT(id>=0&&id<Perft->thread_nb);
+
+   board = &PerftBoard[id];
+   board_copy(board,Perft->board);
+
+   for (i = id; i < LIST_SIZE(Perft->list); i += Perft->thread_nb) {
+
+      move = LIST_MOVE(Perft->list,i);
+
+      if (Perft->depth == 1) {
+         Perft->node_nb[i] = 1;
+      } else {
+         move_do(board,move,undo);
+         Perft->node_nb[i] = perft(board,Perft->depth-1,true);
+         move_undo(board,move,undo);
+      }
+   }
+}
+
+// perft()
+
+static sint64 perft(board_t * board, int depth, bool hash) {
+
+   list_t list[1];
+   undo_t undo[1];
+   sint64 node_nb;
+   int i, move;
+
+   ASSERT(board!=NULL);
+   ASSERT(depth>=1);
+   ASSERT(hash==true||hash==false);
+
+   if (hash && depth >= PerftHashDepth && perft_probe(board->key,depth,&node_nb)) return node_nb;
+
+   gen_legal_moves(list,board);
+
+   if (depth == 1) return LIST_SIZE(list); // bulk counting
+
+   node_nb = 0;
+
+   for (i = 0; i < LIST_SIZE(list); i++) {
+      move = LIST_MOVE(list,i);
+      move_do(board,move,undo);
+      node_nb += perft(board,depth-1,hash);
+      move_undo(board,move,undo);
+   }
+
+   if (hash && depth >= PerftHashDepth) perft_store(board->key,depth,node_nb);
+
+   return node_nb;
+}
+
+// perft_probe()
+
+static bool perft_probe(uint64 key, int depth, sint64 * node_nb) {
+
+   const perft_entry_t * entry;
+   uint64 check, data;
+
+   ASSERT(depth>=PerftHashDepth&&depth<256);
+   ASSERT(node_nb!=NULL);
+
+   entry = &Perft->table[KEY_INDEX(key)&Perft->mask];
+
+   check = entry->check;
+   data = entry->data;
+
+   if ((check ^ data) != key || int(data & 0xFF) != depth) return false;
+
+   *node_nb = sint64(data >> 8);
+
+   return true;
+}
+
+// perft_store()
+
+static void perft_store(uint64 key, int depth, sint64 node_nb) {
+
+   perft_entry_t * entry;
+   uint64 data;
+
+   ASSERT(depth>=PerftHashDepth&&depth<256);
+   ASSERT(node_nb>=0);
+
+   entry = &Perft->table[KEY_INDEX(key)&Perft->mask]; // always replace
+
+   data = (uint64(node_nb) << 8) | uint64(depth);
+
+   entry->check = key ^ data;
+   entry->data = data;
+}
+
+// end of bench.cpp
+
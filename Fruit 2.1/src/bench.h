@@ -0,0 +1,24 @@
+
+// bench.h
+
+#ifndef BENCH_H
+#define BENCH_H
+
+// includes
+
+#include "board.h"
+#include "util.h"
+
+// functions
+
+extern void bench_search   (int depth);
+extern void bench_perft    (const board_t * board, int depth, int thread_nb, bool divide);
+
+extern void bench_smp      (int depth, const int thread_nb[], int size);
+extern void bench_bitboard (int depth, int perft_depth);
+extern void bench_eval     (int round_nb);
+
+#endif // !defined BENCH_H
+
+// end of bench.h
+
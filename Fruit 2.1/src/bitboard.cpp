@@ -0,0 +1,296 @@
+
+// bitboard.cpp
+
+// includes
+
+#include <cstring>
+
+#include "bitboard.h"
+#include "colour.h"
+#include "piece.h"
+#include "square.h"
+#include "util.h"
+#include "vector.h"
+
+// constants
+
+static const int BishopTableSize = 5248;
+static const int RookTableSize = 102400; // 800kB
+
+// variables
+
+uint64 PawnAttack[ColourNb][64];
+uint64 KnightAttack[64];
+uint64 KingAttack[64];
+
+uint64 Between[64][64];
+
+magic_t BishopMagic[64];
+magic_t RookMagic[64];
+
+static uint64 BishopTable[BishopTableSize];
+static uint64 RookTable[RookTableSize];
+
+static uint64 MagicSeed;
+
+// prototypes
+
+static void   init_magic   (magic_t magic[], uint64 table[], int table_size, const inc_t inc[]);
+
+static uint64 slider_mask  (int sq_64, const inc_t inc[]);
+static uint64 slider_slow  (int sq_64, uint64 occ, const inc_t inc[]);
+
+static uint64 leaper_mask  (int sq_64, const inc_t inc[]);
+
+static int    bit_count    (uint64 b);
+
+static uint64 magic_random ();
+
+// functions
+
+// bitboard_init()
+
+void bitboard_init() {
+
+   int sq_64, sq, to;
+   int colour;
+   int dir, inc;
+   uint64 b;
+
+   // leapers
+
+   for (sq_64 = 0; sq_64 < 64; sq_64++) {
+
+      sq = SQUARE_FROM_64(sq_64);
+
+      for (colour = 0; colour < ColourNb; colour++) {
+
+         b = 0;
+
+         inc = PAWN_MOVE_INC(colour);
+         if (SQUARE_IS_OK(sq+inc-1)) b |= SQUARE_BB(sq+inc-1);
+         if (SQUARE_IS_OK(sq+inc+1)) b |= SQUARE_BB(sq+inc+1);
+
+         PawnAttack[colour][sq_64] = b;
+      }
+
+      KnightAttack[sq_64] = leaper_mask(sq_64,KnightInc);
+      KingAttack[sq_64] = leaper_mask(sq_64,KingInc);
+   }
+
+   // Between[][]
+
+   memset(Between,0,sizeof(Between));
+
+   for (sq_64 = 0; sq_64 < 64; sq_64++) {
+
+      sq = SQUARE_FROM_64(sq_64);
+
+      for (dir = 0; (inc=QueenInc[dir]) != IncNone; dir++) {
+
+         b = 0;
+
+         for (to = sq+inc; SQUARE_IS_OK(to); to += inc) {
+            Between[sq_64][SQUARE_TO_64(to)] = b;
+            b |= SQUARE_BB(to);
+         }
+      }
+   }
+
+   // sliders
+
+   MagicSeed = U64(0x9E3779B97F4A7C15); // fixed seed => same tables every run
+
+   init_magic(BishopMagic,BishopTable,BishopTableSize,BishopInc);
+   init_magic(RookMagic,RookTable,RookTableSize,RookInc);
+}
+
+// init_magic()
+
+static void init_magic(magic_t magic[], uint64 table[], int table_size, const inc_t inc[]) {
+
+   int sq_64;
+   int size, bits, total;
+   int i, index;
+   uint64 occ;
+   uint64 occupancy[4096], reference[4096];
+   uint64 * attack;
+#ifndef USE_PEXT
+   int epoch[4096], attempt;
+#endif
+
+   ASSERT(magic!=NULL);
+   ASSERT(table!=NULL);
+   ASSERT(inc!=NULL);
+
+   total = 0;
+
+   for (sq_64 = 0; sq_64 < 64; sq_64++) {
+
+      magic[sq_64].mask = slider_mask(sq_64,inc);
+
+      bits = bit_count(magic[sq_64].mask);
+
+      magic[sq_64].shift = 64 - bits;
+
+      attack = &table[total];
+      magic[sq_64].attack = attack;
+
+      // enumerate all subsets of the mask ("carry rippler")
+
+      size = 0;
+      occ = 0;
+
+      do {
+         occupancy[size] = occ;
+         reference[size] = slider_slow(sq_64,occ,inc);
+         size++;
+         occ = (occ - magic[sq_64].mask) & magic[sq_64].mask;
+      } while (occ != 0);
+
+      ASSERT(size==1<<bits);
+
+      total += size;
+      if (total > table_size) my_fatal("init_magic(): table overflow\n");
+
+#ifdef USE_PEXT
+
+      magic[sq_64].magic = 0;
+
+      for (i = 0; i < size; i++) {
+         index = int(MAGIC_INDEX(&magic[sq_64],occupancy[i]));
+         attack[index] = reference[i];
+      }
+
+#else
+
+      // trial and error with sparse random numbers
+
+      for (i = 0; i < size; i++) epoch[i] = 0;
+
+      for (attempt = 1; true; attempt++) {
+
+         do {
+            magic[sq_64].magic = magic_random() & magic_random() & magic_random();
+         } while (bit_count((magic[sq_64].mask * magic[sq_64].magic) >> 56) < 6);
+
+         for (i = 0; i < size; i++) {
+
+            index = int(MAGIC_INDEX(&magic[sq_64],occupancy[i]));
+
+            if (epoch[index] < attempt) {
+               epoch[index] = attempt;
+               attack[index] = reference[i];
+            } else if (attack[index] != reference[i]) {
+               break; // destructive collision
+            }
+         }
+
+         if (i == size) break; // found
+      }
+
+#endif
+   }
+
+   ASSERT(total==table_size);
+}
+
+// slider_mask()
+
+static uint64 slider_mask(int sq_64, const inc_t inc[]) {
+
+   int sq, to;
+   int dir;
+   uint64 mask;
+
+   ASSERT(sq_64>=0&&sq_64<64);
+   ASSERT(inc!=NULL);
+
+   // relevant occupancy: the last square of each ray cannot block anything
+
+   mask = 0;
+
+   sq = SQUARE_FROM_64(sq_64);
+
+   for (dir = 0; inc[dir] != IncNone; dir++) {
+      for (to = sq+inc[dir]; SQUARE_IS_OK(to+inc[dir]); to += inc[dir]) {
+         mask |= SQUARE_BB(to);
+      }
+   }
+
+   return mask;
+}
+
+// slider_slow()
+
+static uint64 slider_slow(int sq_64, uint64 occ, const inc_t inc[]) {
+
+   int sq, to;
+   int dir;
+   uint64 attack;
+
+   ASSERT(sq_64>=0&&sq_64<64);
+   ASSERT(inc!=NULL);
+
+   attack = 0;
+
+   sq = SQUARE_FROM_64(sq_64);
+
+   for (dir = 0; inc[dir] != IncNone; dir++) {
+      for (to = sq+inc[dir]; SQUARE_IS_OK(to); to += inc[dir]) {
+         attack |= SQUARE_BB(to);
+         if ((occ & SQUARE_BB(to)) != 0) break;
+      }
+   }
+
+   return attack;
+}
+
+// leaper_mask()
+
+static uint64 leaper_mask(int sq_64, const inc_t inc[]) {
+
+   int sq, to;
+   int dir;
+   uint64 mask;
+
+   ASSERT(sq_64>=0&&sq_64<64);
+   ASSERT(inc!=NULL);
+
+   mask = 0;
+
+   sq = SQUARE_FROM_64(sq_64);
+
+   for (dir = 0; inc[dir] != IncNone; dir++) {
+      to = sq + inc[dir];
+      if (SQUARE_IS_OK(to)) mask |= SQUARE_BB(to);
+   }
+
+   return mask;
+}
+
+// bit_count()
+
+static int bit_count(uint64 b) {
+
+   int count;
+
+   for (count = 0; b != 0; b &= b - 1) count++;
+
+   return count;
+}
+
+// magic_random()
+
+static uint64 magic_random() {
+
+   // xorshift64*
+
+   MagicSeed ^= MagicSeed >> 12;
+   MagicSeed ^= MagicSeed << 25;
+   MagicSeed ^= MagicSeed >> 27;
+
+   return MagicSeed * U64(2685821657736338717);
+}
+
+// end of bitboard.cpp
@@ -0,0 +1,85 @@
+
+// bitboard.h
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+// includes
+
+#ifdef USE_PEXT
+#  include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+#include "colour.h"
+#include "square.h"
+#include "util.h"
+
+// macros
+
+#define BB_BIT(sq_64)             ((uint64)1<<(sq_64))
+#define SQUARE_BB(square)         (BB_BIT(SQUARE_TO_64(square)))
+
+#ifdef USE_PEXT
+#  define MAGIC_INDEX(entry,occ)  (_pext_u64((occ),(entry)->mask))
+#else
+#  define MAGIC_INDEX(entry,occ)  (uint32((((occ)&(entry)->mask)*(entry)->magic)>>(entry)->shift))
+#endif
+
+#define BISHOP_ATTACK(sq_64,occ)  (BishopMagic[sq_64].attack[MAGIC_INDEX(&BishopMagic[sq_64],(occ))])
+#define ROOK_ATTACK(sq_64,occ)    (RookMagic[sq_64].attack[MAGIC_INDEX(&RookMagic[sq_64],(occ))])
+
+#define BETWEEN(sq_64_1,sq_64_2)  (Between[sq_64_1][sq_64_2])
+
+// types
+
+struct magic_t {
+   uint64 mask;
+   uint64 magic; // unused with PEXT
+   const uint64 * attack;
+   int shift;
+};
+
+// variables
+
+extern uint64 PawnAttack[ColourNb][64];
+extern uint64 KnightAttack[64];
+extern uint64 KingAttack[64];
+
+extern uint64 Between[64][64]; // 32kB
+
+extern magic_t BishopMagic[64];
+extern magic_t RookMagic[64];
+
+// functions
+
+extern void bitboard_init ();
+
+// bb_first()
+
+inline int bb_first(uint64 b) {
+
+   ASSERT(b!=0);
+
+#if defined(__GNUC__)
+   return __builtin_ctzll(b);
+#elif defined(_MSC_VER) && defined(_WIN64)
+   unsigned long index;
+   _BitScanForward64(&index,b);
+   return int(index);
+#else
+   int index = 0;
+   while ((b & 1) == 0) {
+      b >>= 1;
+      index++;
+   }
+   return index;
+#endif
+}
+
+#endif // !defined BITBOARD_H
+
+// end of bitboard.h
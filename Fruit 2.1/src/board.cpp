@@ -4,6 +4,7 @@
 // includes
 
 #include "attack.h"
+#include "bitboard.h"
 #include "board.h"
 #include "colour.h"
 #include "fen.h"
@@ -32,6 +33,7 @@ bool board_is_ok(const board_t * board) {
 
    int sq, piece, colour;
    int size, pos;
+   int sq_64, piece_12;
 
    if (board == NULL) return false;
 
@@ -150,6 +152,22 @@ bool board_is_ok(const board_t * board) {
    if (board->number[WhiteKing12] != 1) return false;
    if (board->number[BlackKing12] != 1) return false;
 
+   // bitboards
+
+   for (sq_64 = 0; sq_64 < 64; sq_64++) {
+
+      sq = SQUARE_FROM_64(sq_64);
+      piece = board->square[sq];
+
+      for (piece_12 = 0; piece_12 < 12; piece_12++) {
+         if (((board->bb_piece[piece_12] & BB_BIT(sq_64)) != 0) != (piece != Empty && PIECE_TO_12(piece) == piece_12)) return false;
+      }
+
+      for (colour = 0; colour < ColourNb; colour++) {
+         if (((board->bb_colour[colour] & BB_BIT(sq_64)) != 0) != (piece != Empty && COLOUR_IS(piece,colour))) return false;
+      }
+   }
+
    // misc
 
    if (!COLOUR_IS_OK(board->turn)) return false;
@@ -229,6 +247,23 @@ void board_init_list(board_t * board) {
    board->piece_nb = 0;
    for (piece = 0; piece < 12; piece++) board->number[piece] = 0;
 
+   for (piece = 0; piece < 12; piece++) board->bb_piece[piece] = 0;
+   board->bb_colour[White] = 0;
+   board->bb_colour[Black] = 0;
+
+   // bitboards
+
+   for (sq_64 = 0; sq_64 < 64; sq_64++) {
+
+      sq = SQUARE_FROM_64(sq_64);
+      piece = board->square[sq];
+
+      if (piece != Empty && piece_is_ok(piece)) {
+         board->bb_piece[PIECE_TO_12(piece)] |= BB_BIT(sq_64);
+         board->bb_colour[PIECE_COLOUR(piece)] |= BB_BIT(sq_64);
+      }
+   }
+
    // piece lists
 
    for (colour = 0; colour < ColourNb; colour++) {
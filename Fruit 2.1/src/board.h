@@ -42,6 +42,9 @@ const int StackSize = 4096;
 
 #define KING_POS(board,colour) ((board)->piece[colour][0])
 
+#define BOARD_OCC(board)             ((board)->bb_colour[White]|(board)->bb_colour[Black])
+#define BOARD_BB(board,piece_12)     ((board)->bb_piece[piece_12])
+
 // types
 
 struct board_t {
@@ -60,6 +63,9 @@ struct board_t {
 
    int pawn_file[ColourNb][FileNb];
 
+   uint64 bb_piece[12]; // indexed by PIECE_TO_12(), kept alongside square[]
+   uint64 bb_colour[ColourNb];
+
    int turn;
    int flags;
    int ep_square;
@@ -4,16 +4,19 @@
 // includes
 
 #include <cstdlib> // for abs()
+#include <cstring>
 
 #include "attack.h"
 #include "board.h"
 #include "colour.h"
 #include "eval.h"
+#include "hash.h"
 #include "material.h"
 #include "move.h"
 #include "option.h"
 #include "pawn.h"
 #include "piece.h"
+#include "protocol.h"
 #include "see.h"
 #include "util.h"
 #include "value.h"
@@ -23,12 +26,33 @@
 
 #define THROUGH(piece) ((piece)==Empty)
 
+// scaling by a UCI weight, folded away in the eval_comp<true>() instance
+
+#define WEIGHT(value,weight) ((Default)?(value):((value)*(weight))/256)
+
+// types
+
+struct eval_entry_t {
+   uint32 lock;
+   sint32 eval;
+};
+
+struct eval_cache_t {
+   eval_entry_t * table;
+   uint32 size;
+   uint32 mask;
+   sint64 read_nb;
+   sint64 read_hit;
+};
+
 // constants and variables
 
 static /* const */ int PieceActivityWeight = 256; // 100%
 static /* const */ int KingSafetyWeight = 256; // 100%
 static /* const */ int PassedPawnWeight = 256; // 100%
 
+static bool EvalDefault = true; // all three weights above are 100%
+
 static const int KnightUnit = 4;
 static const int BishopUnit = 6;
 static const int RookUnit = 7;
@@ -98,13 +122,17 @@ static int MobUnit[ColourNb][PieceNb];
 
 static int KingAttackUnit[PieceNb];
 
+static THREAD_LOCAL eval_cache_t EvalCache[1]; // one table per search thread
+
 // prototypes
 
+template <bool Default> static int  eval_comp   (const board_t * board);
+
 static void eval_draw          (const board_t * board, const material_info_t * mat_info, const pawn_info_t * pawn_info, int mul[2]);
 
-static void eval_piece         (const board_t * board, const material_info_t * mat_info, const pawn_info_t * pawn_info, int * opening, int * endgame);
-static void eval_king          (const board_t * board, const material_info_t * mat_info, int * opening, int * endgame);
-static void eval_passer        (const board_t * board, const pawn_info_t * pawn_info, int * opening, int * endgame);
+template <bool Default> static void eval_piece  (const board_t * board, const material_info_t * mat_info, const pawn_info_t * pawn_info, int * opening, int * endgame);
+template <bool Default> static void eval_king   (const board_t * board, const material_info_t * mat_info, int * opening, int * endgame);
+template <bool Default> static void eval_passer (const board_t * board, const pawn_info_t * pawn_info, int * opening, int * endgame);
 static void eval_pattern       (const board_t * board, int * opening, int * endgame);
 
 static bool unstoppable_passer (const board_t * board, int pawn, int colour);
@@ -148,6 +176,8 @@ void eval_init() {
    KingSafetyWeight    = (option_get_int("King Safety")    * 256 + 50) / 100;
    PassedPawnWeight    = (option_get_int("Passed Pawns")   * 256 + 50) / 100;
 
+   EvalDefault = PieceActivityWeight == 256 && KingSafetyWeight == 256 && PassedPawnWeight == 256;
+
    // mobility table
 
    for (colour = 0; colour < ColourNb; colour++) {
@@ -205,10 +235,127 @@ void eval_init() {
    KingAttackUnit[BQ] = 4;
 }
 
+// eval_alloc()
+
+void eval_alloc() {
+
+   uint32 size, target;
+
+   ASSERT(sizeof(eval_entry_t)==8);
+
+   EvalCache->table = NULL;
+   EvalCache->size = 0;
+   EvalCache->mask = 0;
+
+   // size (kB) is a UCI option, 0 disables the cache
+
+   target = uint32(option_get_int("Eval Cache")) * 1024 / sizeof(eval_entry_t);
+
+   if (target != 0) {
+
+      for (size = 1; size * 2 <= target; size *= 2)
+         ;
+
+      EvalCache->size = size;
+      EvalCache->mask = size - 1;
+      EvalCache->table = (eval_entry_t *) my_malloc(EvalCache->size*sizeof(eval_entry_t));
+   }
+
+   eval_clear();
+}
+
+// eval_free()
+
+void eval_free() {
+
+   if (EvalCache->table != NULL) {
+      my_free(EvalCache->table);
+      EvalCache->table = NULL;
+   }
+
+   EvalCache->size = 0;
+   EvalCache->mask = 0;
+}
+
+// eval_clear()
+
+void eval_clear() {
+
+   if (EvalCache->table != NULL) {
+      memset(EvalCache->table,0,EvalCache->size*sizeof(eval_entry_t));
+   }
+
+   EvalCache->read_nb = 0;
+   EvalCache->read_hit = 0;
+}
+
+// eval_stats()
+
+void eval_stats() {
+
+   double hit;
+
+   // counters cover the period since the last report (main thread only)
+
+   hit = (EvalCache->read_nb != 0) ? double(EvalCache->read_hit) / double(EvalCache->read_nb) : 0.0;
+
+   send("info string eval cache " S64_FORMAT "kB reads " S64_FORMAT " hit %.1f%% miss " S64_FORMAT,
+        sint64(EvalCache->size*sizeof(eval_entry_t)/1024),EvalCache->read_nb,hit*100.0,EvalCache->read_nb-EvalCache->read_hit);
+
+   EvalCache->read_nb = 0;
+   EvalCache->read_hit = 0;
+}
+
 // eval()
 
 int eval(const board_t * board) {
 
+   uint64 key;
+   eval_entry_t * entry;
+   int value;
+
+   ASSERT(board!=NULL);
+
+   if (EvalCache->table == NULL) return eval_uncached(board,!EvalDefault);
+
+   // probe
+
+   EvalCache->read_nb++;
+
+   key = board->key;
+   entry = &EvalCache->table[KEY_INDEX(key)&EvalCache->mask];
+
+   if (entry->lock == KEY_LOCK(key)) { // HACK: assume no free-entry match
+      EvalCache->read_hit++;
+      return entry->eval;
+   }
+
+   // calculation
+
+   value = eval_uncached(board,!EvalDefault);
+
+   // store (always replace)
+
+   entry->lock = KEY_LOCK(key);
+   entry->eval = value;
+
+   return value;
+}
+
+// eval_uncached()
+
+int eval_uncached(const board_t * board, bool generic) {
+
+   ASSERT(board!=NULL);
+   ASSERT(generic==true||generic==false);
+
+   return (generic) ? eval_comp<false>(board) : eval_comp<true>(board);
+}
+
+// eval_comp()
+
+template <bool Default> static int eval_comp(const board_t * board) {
+
    int opening, endgame;
    material_info_t mat_info[1];
    pawn_info_t pawn_info[1];
@@ -260,9 +407,9 @@ int eval(const board_t * board) {
 
    // eval
 
-   eval_piece(board,mat_info,pawn_info,&opening,&endgame);
-   eval_king(board,mat_info,&opening,&endgame);
-   eval_passer(board,pawn_info,&opening,&endgame);
+   eval_piece<Default>(board,mat_info,pawn_info,&opening,&endgame);
+   eval_king<Default>(board,mat_info,&opening,&endgame);
+   eval_passer<Default>(board,pawn_info,&opening,&endgame);
    eval_pattern(board,&opening,&endgame);
 
    // phase mix
@@ -550,7 +697,7 @@ static void eval_draw(const board_t * board, const material_info_t * mat_info, c
 
 // eval_piece()
 
-static void eval_piece(const board_t * board, const material_info_t * mat_info, const pawn_info_t * pawn_info, int * opening, int * endgame) {
+template <bool Default> static void eval_piece(const board_t * board, const material_info_t * mat_info, const pawn_info_t * pawn_info, int * opening, int * endgame) {
 
    int colour;
    int op[ColourNb], eg[ColourNb];
@@ -758,13 +905,13 @@ static void eval_piece(const board_t * board, const material_info_t * mat_info,
 
    // update
 
-   *opening += ((op[White] - op[Black]) * PieceActivityWeight) / 256;
-   *endgame += ((eg[White] - eg[Black]) * PieceActivityWeight) / 256;
+   *opening += WEIGHT(op[White]-op[Black],PieceActivityWeight);
+   *endgame += WEIGHT(eg[White]-eg[Black],PieceActivityWeight);
 }
 
 // eval_king()
 
-static void eval_king(const board_t * board, const material_info_t * mat_info, int * opening, int * endgame) {
+template <bool Default> static void eval_king(const board_t * board, const material_info_t * mat_info, int * opening, int * endgame) {
 
    int colour;
    int op[ColourNb], eg[ColourNb];
@@ -897,13 +1044,13 @@ static void eval_king(const board_t * board, const material_info_t * mat_info, i
 
    // update
 
-   *opening += ((op[White] - op[Black]) * KingSafetyWeight) / 256;
-   *endgame += ((eg[White] - eg[Black]) * KingSafetyWeight) / 256;
+   *opening += WEIGHT(op[White]-op[Black],KingSafetyWeight);
+   *endgame += WEIGHT(eg[White]-eg[Black],KingSafetyWeight);
 }
 
 // eval_passer()
 
-static void eval_passer(const board_t * board, const pawn_info_t * pawn_info, int * opening, int * endgame) {
+template <bool Default> static void eval_passer(const board_t * board, const pawn_info_t * pawn_info, int * opening, int * endgame) {
 
    int colour;
    int op[ColourNb], eg[ColourNb];
@@ -982,8 +1129,8 @@ static void eval_passer(const board_t * board, const pawn_info_t * pawn_info, in
 
    // update
 
-   *opening += ((op[White] - op[Black]) * PassedPawnWeight) / 256;
-   *endgame += ((eg[White] - eg[Black]) * PassedPawnWeight) / 256;
+   *opening += WEIGHT(op[White]-op[Black],PassedPawnWeight);
+   *endgame += WEIGHT(eg[White]-eg[Black],PassedPawnWeight);
 }
 
 // eval_pattern()
@@ -11,9 +11,15 @@
 
 // functions
 
-extern void eval_init ();
+extern void eval_init     ();
 
-extern int  eval      (const board_t * board);
+extern void eval_alloc    ();
+extern void eval_free     ();
+extern void eval_clear    ();
+extern void eval_stats    ();
+
+extern int  eval          (const board_t * board);
+extern int  eval_uncached (const board_t * board, bool generic);
 
 #endif // !defined EVAL_H
 
@@ -102,6 +102,43 @@ void list_sort(list_t * list) {
    }
 }
 
+// list_select()
+
+void list_select(list_t * list, int pos) {
+
+   int size;
+   int best, i;
+   int move, value;
+
+   ASSERT(list_is_ok(list));
+   ASSERT(pos>=0&&pos<list->size);
+
+   // find the best remaining move (first one on ties)
+
+   size = list->size;
+   best = pos;
+
+   for (i = pos+1; i < size; i++) {
+      if (list->value[i] > list->value[best]) best = i;
+   }
+
+   // rotate it to "pos", same order as list_sort() (stable)
+
+   if (best != pos) {
+
+      move = list->move[best];
+      value = list->value[best];
+
+      for (i = best; i > pos; i--) {
+         list->move[i] = list->move[i-1];
+         list->value[i] = list->value[i-1];
+      }
+
+      list->move[pos] = move;
+      list->value[pos] = value;
+   }
+}
+
 // list_contain()
 
 bool list_contain(const list_t * list, int move) {
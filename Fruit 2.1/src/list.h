@@ -43,6 +43,7 @@ extern void list_remove   (list_t * list, int pos);
 extern void list_copy     (list_t * dst, const list_t * src);
 
 extern void list_sort     (list_t * list);
+extern void list_select   (list_t * list, int pos);
 
 extern bool list_contain  (const list_t * list, int move);
 extern void list_note     (list_t * list);
@@ -7,6 +7,7 @@
 #include <cstdlib>
 
 #include "attack.h"
+#include "bitboard.h"
 #include "book.h"
 #include "hash.h"
 #include "move_do.h"
@@ -44,6 +45,7 @@ int main(int argc, char * argv[]) {
    value_init();
    vector_init();
    attack_init();
+   bitboard_init();
    move_do_init();
 
    random_init();
@@ -18,7 +18,6 @@
 // constants
 
 static const bool UseTable = true;
-static const uint32 TableSize = 256; // 4kB
 
 static const int PawnPhase   = 0;
 static const int KnightPhase = 1;
@@ -63,7 +62,7 @@ struct material_t {
 
 // variables
 
-static material_t Material[1];
+static THREAD_LOCAL material_t Material[1]; // one table per search thread
 
 // prototypes
 
@@ -90,18 +89,42 @@ void material_init() {
 
 void material_alloc() {
 
+   uint32 size, target;
+
    ASSERT(sizeof(entry_t)==16);
 
    if (UseTable) {
 
-      Material->size = TableSize;
-      Material->mask = TableSize - 1;
+      // size (kB) is a UCI option, round down to a power of 2
+
+      target = uint32(option_get_int("Material Hash"));
+      if (target < 1) target = 1;
+      target = target * 1024 / sizeof(entry_t);
+
+      for (size = 1; size * 2 <= target; size *= 2)
+         ;
+
+      Material->size = size;
+      Material->mask = size - 1;
       Material->table = (entry_t *) my_malloc(Material->size*sizeof(entry_t));
 
       material_clear();
    }
 }
 
+// material_free()
+
+void material_free() {
+
+   if (Material->table != NULL) {
+      my_free(Material->table);
+      Material->table = NULL;
+   }
+
+   Material->size = 0;
+   Material->mask = 0;
+}
+
 // material_clear()
 
 void material_clear() {
@@ -117,6 +140,26 @@ void material_clear() {
    Material->write_collision = 0;
 }
 
+// material_stats()
+
+void material_stats() {
+
+   double hit, collision;
+
+   // counters cover the period since the last report (main thread only)
+
+   hit = (Material->read_nb != 0) ? double(Material->read_hit) / double(Material->read_nb) : 0.0;
+   collision = (Material->write_nb != 0) ? double(Material->write_collision) / double(Material->write_nb) : 0.0;
+
+   send("info string material hash " S64_FORMAT "kB reads " S64_FORMAT " hit %.1f%% writes " S64_FORMAT " collision %.1f%%",
+        sint64(Material->size*sizeof(entry_t)/1024),Material->read_nb,hit*100.0,Material->write_nb,collision*100.0);
+
+   Material->read_nb = 0;
+   Material->read_hit = 0;
+   Material->write_nb = 0;
+   Material->write_collision = 0;
+}
+
 // material_get_info()
 
 void material_get_info(material_info_t * info, const board_t * board) {
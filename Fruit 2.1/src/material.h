@@ -53,7 +53,9 @@ struct material_info_t {
 extern void material_init     ();
 
 extern void material_alloc    ();
+extern void material_free     ();
 extern void material_clear    ();
+extern void material_stats    ();
 
 extern void material_get_info (material_info_t * info, const board_t * board);
 
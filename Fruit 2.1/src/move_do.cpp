@@ -4,6 +4,7 @@
 // includes
 
 #include "attack.h"
+#include "bitboard.h"
 #include "board.h"
 #include "colour.h"
 #include "hash.h"
@@ -419,6 +420,11 @@ static void square_clear(board_t * board, int square, int piece, bool update) {
    ASSERT(board->square[square]==piece);
    board->square[square] = Empty;
 
+   // bitboards
+
+   board->bb_piece[piece_12] ^= SQUARE_BB(square);
+   board->bb_colour[colour] ^= SQUARE_BB(square);
+
    // piece list
 
    if (!PIECE_IS_PAWN(piece)) {
@@ -548,6 +554,11 @@ static void square_set(board_t * board, int square, int piece, int pos, bool upd
    ASSERT(board->square[square]==Empty);
    board->square[square] = piece;
 
+   // bitboards
+
+   board->bb_piece[piece_12] ^= SQUARE_BB(square);
+   board->bb_colour[colour] ^= SQUARE_BB(square);
+
    // piece list
 
    if (!PIECE_IS_PAWN(piece)) {
@@ -695,6 +706,11 @@ static void square_move(board_t * board, int from, int to, int piece, bool updat
    ASSERT(board->pos[to]==-1);
    board->pos[to] = pos;
 
+   // bitboards
+
+   board->bb_piece[PIECE_TO_12(piece)] ^= SQUARE_BB(from) | SQUARE_BB(to);
+   board->bb_colour[colour] ^= SQUARE_BB(from) | SQUARE_BB(to);
+
    // piece list
 
    if (!PIECE_IS_PAWN(piece)) {
@@ -4,6 +4,7 @@
 // includes
 
 #include "attack.h"
+#include "bitboard.h"
 #include "colour.h"
 #include "fen.h"
 #include "list.h"
@@ -222,7 +223,9 @@ bool pseudo_is_legal(int move, board_t * board) {
       if (DEBUG) {
          ASSERT(board->square[from]==piece);
          board->square[from] = Empty;
+         board->bb_colour[me] ^= SQUARE_BB(from); // keep occupancy in sync
          ASSERT(legal==!is_attacked(board,to,opp));
+         board->bb_colour[me] ^= SQUARE_BB(from);
          board->square[from] = piece;
       }
 
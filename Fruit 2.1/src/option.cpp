@@ -24,7 +24,17 @@ struct option_t {
 
 static option_t Option[] = {
 
-   { "Hash", true, "16", "spin", "min 4 max 1024", NULL },
+   { "Hash", true, "16", "spin", "min 4 max 65536", NULL },
+
+   { "Large Pages", true, "false", "check", "", NULL },
+
+   { "Threads", true, "1", "spin", "min 1 max 64", NULL },
+
+   { "Bitboard Attacks", true, "true", "check", "", NULL },
+
+   { "Eval Cache",    true, "1024", "spin", "min 0 max 65536", NULL },
+   { "Pawn Hash",     true, "256",  "spin", "min 16 max 65536", NULL },
+   { "Material Hash", true, "4",    "spin", "min 1 max 4096", NULL },
 
    { "Ponder", true, "false", "check", "", NULL },
 
@@ -18,7 +18,6 @@
 // constants
 
 static const bool UseTable = true;
-static const uint32 TableSize = 16384; // 256kB
 
 // types
 
@@ -79,7 +78,7 @@ int BitLast[0x100];
 int BitCount[0x100];
 int BitRev[0x100];
 
-static pawn_t Pawn[1];
+static THREAD_LOCAL pawn_t Pawn[1]; // one table per search thread
 
 static int BitRank1[RankNb];
 static int BitRank2[RankNb];
@@ -183,18 +182,42 @@ void pawn_init() {
 
 void pawn_alloc() {
 
+   uint32 size, target;
+
    ASSERT(sizeof(entry_t)==16);
 
    if (UseTable) {
 
-      Pawn->size = TableSize;
-      Pawn->mask = TableSize - 1;
+      // size (kB) is a UCI option, round down to a power of 2
+
+      target = uint32(option_get_int("Pawn Hash"));
+      if (target < 16) target = 16;
+      target = target * 1024 / sizeof(entry_t);
+
+      for (size = 1; size * 2 <= target; size *= 2)
+         ;
+
+      Pawn->size = size;
+      Pawn->mask = size - 1;
       Pawn->table = (entry_t *) my_malloc(Pawn->size*sizeof(entry_t));
 
       pawn_clear();
    }
 }
 
+// pawn_free()
+
+void pawn_free() {
+
+   if (Pawn->table != NULL) {
+      my_free(Pawn->table);
+      Pawn->table = NULL;
+   }
+
+   Pawn->size = 0;
+   Pawn->mask = 0;
+}
+
 // pawn_clear()
 
 void pawn_clear() {
@@ -210,6 +233,26 @@ void pawn_clear() {
    Pawn->write_collision = 0;
 }
 
+// pawn_stats()
+
+void pawn_stats() {
+
+   double hit, collision;
+
+   // counters cover the period since the last report (main thread only)
+
+   hit = (Pawn->read_nb != 0) ? double(Pawn->read_hit) / double(Pawn->read_nb) : 0.0;
+   collision = (Pawn->write_nb != 0) ? double(Pawn->write_collision) / double(Pawn->write_nb) : 0.0;
+
+   send("info string pawn hash " S64_FORMAT "kB reads " S64_FORMAT " hit %.1f%% writes " S64_FORMAT " collision %.1f%%",
+        sint64(Pawn->size*sizeof(entry_t)/1024),Pawn->read_nb,hit*100.0,Pawn->write_nb,collision*100.0);
+
+   Pawn->read_nb = 0;
+   Pawn->read_hit = 0;
+   Pawn->write_nb = 0;
+   Pawn->write_collision = 0;
+}
+
 // pawn_get_info()
 
 void pawn_get_info(pawn_info_t * info, const board_t * board) {
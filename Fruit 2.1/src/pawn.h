@@ -53,7 +53,9 @@ extern void pawn_init_bit ();
 extern void pawn_init     ();
 
 extern void pawn_alloc    ();
+extern void pawn_free     ();
 extern void pawn_clear    ();
+extern void pawn_stats    ();
 
 extern void pawn_get_info (pawn_info_t * info, const board_t * board);
 
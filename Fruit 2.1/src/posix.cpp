@@ -12,6 +12,8 @@
 #if defined(_WIN32) || defined(_WIN64)
 #  include <windows.h>
 #else // assume POSIX
+#  include <pthread.h>
+#  include <sys/mman.h>
 #  include <sys/resource.h>
 // #  include <sys/select.h>
 #  include <sys/time.h>
@@ -26,10 +28,16 @@
 
 static const bool UseDebug = false;
 
+static const uint64 CacheLineSize = 64;
+static const uint64 LargePageSize = 2 * 1024 * 1024; // x86 huge page
+
 // prototypes
 
-#if !defined(_WIN32) && !defined(_WIN64)
+#if defined(_WIN32) || defined(_WIN64)
+static DWORD WINAPI thread_start (LPVOID param);
+#else
 static double duration (const struct timeval * tv);
+static void * thread_start (void * param);
 #endif
 
 // functions
@@ -175,6 +183,153 @@ double now_cpu() {
 #endif
 }
 
+// my_thread_create()
+
+void my_thread_create(my_thread_t * thread, void (*func) (int arg), int arg) {
+
+#if !defined(_WIN32) && !defined(_WIN64)
+   pthread_t * handle;
+   int error;
+#endif
+
+   ASSERT(thread!=NULL);
+   ASSERT(func!=NULL);
+
+   thread->func = func;
+   thread->arg = arg;
+
+#if defined(_WIN32) || defined(_WIN64)
+
+   thread->handle = CreateThread(NULL,0,thread_start,thread,0,NULL);
+   if (thread->handle == NULL) my_fatal("my_thread_create(): CreateThread() failed\n");
+
+#else // assume POSIX
+
+   handle = (pthread_t *) my_malloc(sizeof(pthread_t));
+
+   error = pthread_create(handle,NULL,thread_start,thread);
+   if (error != 0) my_fatal("my_thread_create(): pthread_create(): %s\n",strerror(error));
+
+   thread->handle = handle;
+
+#endif
+}
+
+// my_thread_join()
+
+void my_thread_join(my_thread_t * thread) {
+
+   ASSERT(thread!=NULL);
+   ASSERT(thread->handle!=NULL);
+
+#if defined(_WIN32) || defined(_WIN64)
+
+   WaitForSingleObject((HANDLE)thread->handle,INFINITE);
+   CloseHandle((HANDLE)thread->handle);
+
+#else // assume POSIX
+
+   pthread_join(*(pthread_t *)thread->handle,NULL);
+   my_free(thread->handle);
+
+#endif
+
+   thread->handle = NULL;
+}
+
+// my_aligned_alloc()
+
+void * my_aligned_alloc(uint64 size, bool large, bool * is_large) {
+
+   void * address = NULL; // my_fatal() is not known to return
+
+#if defined(_WIN32) || defined(_WIN64)
+   SIZE_T page;
+#else
+   uint64 align;
+   int error;
+#endif
+
+   ASSERT(size>0);
+   ASSERT(large==true||large==false);
+   ASSERT(is_large!=NULL);
+
+   *is_large = false;
+
+#if defined(_WIN32) || defined(_WIN64)
+
+   // large pages need the "Lock pages in memory" privilege, fall back silently
+
+   if (large && (page = GetLargePageMinimum()) != 0) {
+      address = VirtualAlloc(NULL,SIZE_T((size+page-1)/page*page),MEM_RESERVE|MEM_COMMIT|MEM_LARGE_PAGES,PAGE_READWRITE);
+      if (address != NULL) *is_large = true;
+   }
+
+   if (address == NULL) { // page aligned
+      address = VirtualAlloc(NULL,SIZE_T(size),MEM_RESERVE|MEM_COMMIT,PAGE_READWRITE);
+   }
+
+   if (address == NULL) my_fatal("my_aligned_alloc(): VirtualAlloc() failed\n");
+
+#else // assume POSIX
+
+   align = (large) ? LargePageSize : CacheLineSize;
+
+   error = posix_memalign(&address,size_t(align),size_t(size));
+   if (error != 0) my_fatal("my_aligned_alloc(): posix_memalign(): %s\n",strerror(error));
+
+#  ifdef MADV_HUGEPAGE
+   if (large) *is_large = madvise(address,size_t(size),MADV_HUGEPAGE) == 0; // transparent huge pages
+#  endif
+
+#endif
+
+   ASSERT((uint64(address)&(CacheLineSize-1))==0);
+
+   return address;
+}
+
+// my_aligned_free()
+
+void my_aligned_free(void * address) {
+
+   ASSERT(address!=NULL);
+
+#if defined(_WIN32) || defined(_WIN64)
+   VirtualFree(address,0,MEM_RELEASE);
+#else // assume POSIX
+   free(address);
+#endif
+}
+
+// thread_start()
+
+#if defined(_WIN32) || defined(_WIN64)
+
+static DWORD WINAPI thread_start(LPVOID param) {
+
+   my_thread_t * thread;
+
+   thread = (my_thread_t *) param;
+   thread->func(thread->arg);
+
+   return 0;
+}
+
+#else // assume POSIX
+
+static void * thread_start(void * param) {
+
+   my_thread_t * thread;
+
+   thread = (my_thread_t *) param;
+   thread->func(thread->arg);
+
+   return NULL;
+}
+
+#endif
+
 // duration()
 
 #if !defined(_WIN32) && !defined(_WIN64)
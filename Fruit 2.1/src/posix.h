@@ -8,12 +8,26 @@
 
 #include "util.h"
 
+// types
+
+struct my_thread_t {
+   void * handle;
+   void (*func) (int arg);
+   int arg;
+};
+
 // functions
 
-extern bool   input_available ();
+extern bool   input_available  ();
+
+extern double now_real         ();
+extern double now_cpu          ();
+
+extern void   my_thread_create (my_thread_t * thread, void (*func) (int arg), int arg);
+extern void   my_thread_join   (my_thread_t * thread);
 
-extern double now_real        ();
-extern double now_cpu         ();
+extern void * my_aligned_alloc (uint64 size, bool large, bool * is_large);
+extern void   my_aligned_free  (void * address);
 
 #endif // !defined POSIX_H
 
@@ -8,6 +8,8 @@
 #include <cstdlib>
 #include <cstring>
 
+#include "attack.h"
+#include "bench.h"
 #include "board.h"
 #include "book.h"
 #include "eval.h"
@@ -22,6 +24,7 @@
 #include "protocol.h"
 #include "pst.h"
 #include "search.h"
+#include "sort.h"
 #include "trans.h"
 #include "util.h"
 
@@ -45,6 +48,11 @@ static bool Delay; // postpone "bestmove" in infinite/ponder mode?
 static void init              ();
 static void loop_step         ();
 
+static void parse_bench       (char string[]);
+static void parse_bitbench    (char string[]);
+static void parse_evalbench   (char string[]);
+static void parse_perft       (char string[], bool divide);
+static void parse_smpbench    (char string[]);
 static void parse_go          (char string[]);
 static void parse_position    (char string[]);
 static void parse_setoption   (char string[]);
@@ -68,6 +76,8 @@ void loop() {
    Infinite = false;
    Delay = false;
 
+   SearchBench = false;
+
    search_clear();
 
    board_from_fen(SearchInput->board,StartFen);
@@ -101,6 +111,9 @@ static void init() {
 
       pst_init();
       eval_init();
+      eval_alloc();
+
+      UseBitboard = option_get_bool("Bitboard Attacks");
    }
 }
 
@@ -125,10 +138,64 @@ static void loop_step() {
 
    if (false) {
 
+   } else if (string_equal(string,"bench") || string_start_with(string,"bench ")) {
+
+      if (!Searching && !Delay) {
+         init();
+         parse_bench(string);
+      } else {
+         ASSERT(false);
+      }
+
+   } else if (string_start_with(string,"bitbench")) {
+
+      if (!Searching && !Delay) {
+         init();
+         parse_bitbench(string);
+      } else {
+         ASSERT(false);
+      }
+
    } else if (string_start_with(string,"debug ")) {
 
       // dummy
 
+   } else if (string_start_with(string,"perft ")) {
+
+      if (!Searching && !Delay) {
+         init();
+         parse_perft(string,false);
+      } else {
+         ASSERT(false);
+      }
+
+   } else if (string_start_with(string,"smpbench")) {
+
+      if (!Searching && !Delay) {
+         init();
+         parse_smpbench(string);
+      } else {
+         ASSERT(false);
+      }
+
+   } else if (string_start_with(string,"divide ")) {
+
+      if (!Searching && !Delay) {
+         init();
+         parse_perft(string,true);
+      } else {
+         ASSERT(false);
+      }
+
+   } else if (string_start_with(string,"evalbench")) {
+
+      if (!Searching && !Delay) {
+         init();
+         parse_evalbench(string);
+      } else {
+         ASSERT(false);
+      }
+
    } else if (string_start_with(string,"go ")) {
 
       if (!Searching && !Delay) {
@@ -224,6 +291,151 @@ static void loop_step() {
    }
 }
 
+// parse_bench()
+
+static void parse_bench(char string[]) {
+
+   const char * ptr;
+   int depth;
+
+   // "bench [depth]", fixed-depth searches of the bench positions
+
+   depth = 8;
+
+   ptr = strtok(string," "); // skip "bench"
+
+   ptr = strtok(NULL," ");
+   if (ptr != NULL) depth = atoi(ptr);
+
+   if (depth < 1) depth = 1;
+   if (depth > DepthMax - 1) depth = DepthMax - 1;
+
+   SearchBench = true;
+   bench_search(depth);
+   SearchBench = false;
+}
+
+// parse_smpbench()
+
+static void parse_smpbench(char string[]) {
+
+   const char * ptr;
+   int depth;
+   int thread_nb[ThreadMax];
+   int size;
+   int n;
+
+   // "smpbench [depth [threads ...]]", time to depth for each thread count
+
+   depth = 10;
+   size = 0;
+
+   ptr = strtok(string," "); // skip "smpbench"
+
+   ptr = strtok(NULL," ");
+   if (ptr != NULL) depth = atoi(ptr);
+
+   if (depth < 1) depth = 1;
+   if (depth > DepthMax - 1) depth = DepthMax - 1;
+
+   for (ptr = strtok(NULL," "); ptr != NULL && size < ThreadMax; ptr = strtok(NULL," ")) {
+      thread_nb[size] = atoi(ptr);
+      if (thread_nb[size] < 1) thread_nb[size] = 1;
+      if (thread_nb[size] > ThreadMax) thread_nb[size] = ThreadMax;
+      size++;
+   }
+
+   if (size == 0) { // 1, 2, 4, ..., ThreadMax
+      for (n = 1; n <= ThreadMax; n *= 2) thread_nb[size++] = n;
+   }
+
+   SearchBench = true;
+   bench_smp(depth,thread_nb,size);
+   SearchBench = false;
+}
+
+// parse_bitbench()
+
+static void parse_bitbench(char string[]) {
+
+   const char * ptr;
+   int depth, perft_depth;
+
+   // "bitbench [depth [perft-depth]]", ray walkers against bitboard attacks
+
+   depth = 8;
+   perft_depth = 4;
+
+   ptr = strtok(string," "); // skip "bitbench"
+
+   ptr = strtok(NULL," ");
+   if (ptr != NULL) depth = atoi(ptr);
+
+   ptr = strtok(NULL," ");
+   if (ptr != NULL) perft_depth = atoi(ptr);
+
+   if (depth < 1) depth = 1;
+   if (depth > DepthMax - 1) depth = DepthMax - 1;
+
+   if (perft_depth < 1) perft_depth = 1;
+   if (perft_depth > 8) perft_depth = 8;
+
+   SearchBench = true;
+   bench_bitboard(depth,perft_depth);
+   SearchBench = false;
+}
+
+// parse_perft()
+
+static void parse_perft(char string[], bool divide) {
+
+   const char * ptr;
+   int depth;
+   int thread_nb;
+
+   // "perft depth [threads]" and "divide depth [threads]" from the current position
+
+   depth = 1;
+   thread_nb = option_get_int("Threads");
+
+   ptr = strtok(string," "); // skip "perft"/"divide"
+
+   ptr = strtok(NULL," ");
+   if (ptr != NULL) depth = atoi(ptr);
+
+   ptr = strtok(NULL," ");
+   if (ptr != NULL) thread_nb = atoi(ptr);
+
+   if (depth < 1) depth = 1;
+   if (depth > 20) depth = 20;
+
+   if (thread_nb < 1) thread_nb = 1;
+   if (thread_nb > ThreadMax) thread_nb = ThreadMax;
+
+   bench_perft(SearchInput->board,depth,thread_nb,divide);
+}
+
+// parse_evalbench()
+
+static void parse_evalbench(char string[]) {
+
+   const char * ptr;
+   int round_nb;
+
+   // "evalbench [rounds]", eval() calls per second for both eval_comp<>() instances
+
+   round_nb = 1000;
+
+   ptr = strtok(string," "); // skip "evalbench"
+
+   ptr = strtok(NULL," ");
+   if (ptr != NULL) round_nb = atoi(ptr);
+
+   if (round_nb < 1) round_nb = 1;
+
+   bench_eval(round_nb);
+}
+
 // parse_go()
 
 static void parse_go(char string[]) {
@@ -510,9 +722,14 @@ static void parse_setoption(char string[]) {
 
    option_set(name,value);
 
+   if (my_string_equal(name,"Bitboard Attacks")) {
+      ASSERT(!Searching);
+      UseBitboard = option_get_bool("Bitboard Attacks");
+   }
+
    // update transposition-table size if needed
 
-   if (Init && my_string_equal(name,"Hash")) { // Init => already allocated
+   if (Init && (my_string_equal(name,"Hash") || my_string_equal(name,"Large Pages"))) { // Init => already allocated
 
       ASSERT(!Searching);
 
@@ -521,6 +738,26 @@ static void parse_setoption(char string[]) {
          trans_alloc(Trans);
       }
    }
+
+   // update evaluation-table sizes if needed (helper threads allocate their own per search)
+
+   if (Init && my_string_equal(name,"Eval Cache")) {
+      ASSERT(!Searching);
+      eval_free();
+      eval_alloc();
+   }
+
+   if (Init && my_string_equal(name,"Pawn Hash")) {
+      ASSERT(!Searching);
+      pawn_free();
+      pawn_alloc();
+   }
+
+   if (Init && my_string_equal(name,"Material Hash")) {
+      ASSERT(!Searching);
+      material_free();
+      material_alloc();
+   }
 }
 
 // send_best_move()
@@ -546,8 +783,10 @@ static void send_best_move() {
    send("info time %.0f nodes " S64_FORMAT " nps %.0f cpuload %.0f",time*1000.0,node_nb,speed,cpu*1000.0);
 
    trans_stats(Trans);
-   // pawn_stats();
-   // material_stats();
+   eval_stats();
+   pawn_stats();
+   material_stats();
+   sort_stats();
 
    // best move
 
@@ -581,7 +820,7 @@ void get(char string[], int size) {
 void send(const char format[], ...) {
 
    va_list arg_list;
-   char string[4096];
+   char string[65536]; // JSON reports can be long
 
    ASSERT(format!=NULL);
 
@@ -9,6 +9,7 @@
 #include "board.h"
 #include "book.h"
 #include "colour.h"
+#include "eval.h"
 #include "list.h"
 #include "material.h"
 #include "move.h"
@@ -58,9 +59,21 @@ search_root_t SearchRoot[1];
 search_current_t SearchCurrent[1];
 search_best_t SearchBest[1];
 
+search_thread_t SearchThread[ThreadMax];
+THREAD_LOCAL search_thread_t * SearchLocal;
+
+bool SearchBench; // benchmark running, leave queued commands to the main loop
+
+static int ThreadNb; // threads in the current search, including the main thread
+static volatile bool HelperStop;
+
 // prototypes
 
-static void search_send_stat ();
+static void search_send_stat     ();
+
+static void search_start_helpers ();
+static void search_stop_helpers  ();
+static void search_helper        (int id);
 
 // functions
 
@@ -82,6 +95,8 @@ bool height_is_ok(int height) {
 
 void search_clear() {
 
+   int i;
+
    // SearchInput
 
    SearchInput->infinite = false;
@@ -90,12 +105,12 @@ void search_clear() {
    SearchInput->time_is_limited = false;
    SearchInput->time_limit_1 = 0.0;
    SearchInput->time_limit_2 = 0.0;
+   SearchInput->display = true;
 
    // SearchInfo
 
    SearchInfo->can_stop = false;
    SearchInfo->stop = false;
-   SearchInfo->check_nb = 10000; // was 100000
    SearchInfo->check_inc = 10000; // was 100000
    SearchInfo->last_time = 0.0;
 
@@ -126,6 +141,18 @@ void search_clear() {
    SearchCurrent->time = 0.0;
    SearchCurrent->speed = 0.0;
    SearchCurrent->cpu = 0.0;
+
+   // SearchThread
+
+   for (i = 0; i < ThreadMax; i++) {
+      SearchThread[i].id = i;
+      SearchThread[i].max_depth = 0;
+      SearchThread[i].check_nb = SearchInfo->check_inc;
+      SearchThread[i].node_nb = 0;
+   }
+
+   SearchLocal = &SearchThread[0];
+   ThreadNb = 1;
 }
 
 // search()
@@ -174,6 +201,7 @@ void search() {
    if (setjmp(SearchInfo->buf) != 0) {
       ASSERT(SearchInfo->can_stop);
       ASSERT(SearchBest->move!=MoveNone);
+      search_stop_helpers();
       search_update_current();
       return;
    }
@@ -195,11 +223,13 @@ void search() {
    sort_init();
    search_full_init(SearchRoot->list,SearchCurrent->board);
 
+   search_start_helpers();
+
    // iterative deepening
 
    for (depth = 1; depth < DepthMax; depth++) {
 
-      if (DispDepthStart) send("info depth %d",depth);
+      if (DispDepthStart && SearchInput->display) send("info depth %d",depth);
 
       SearchRoot->bad_1 = false;
       SearchRoot->change = false;
@@ -214,7 +244,7 @@ void search() {
 
       search_update_current();
 
-      if (DispDepthEnd) {
+      if (DispDepthEnd && SearchInput->display) {
          send("info depth %d seldepth %d time %.0f nodes " S64_FORMAT " nps %.0f",depth,SearchCurrent->max_depth,SearchCurrent->time*1000.0,SearchCurrent->node_nb,SearchCurrent->speed);
       }
 
@@ -271,6 +301,8 @@ void search() {
          break;
       }
    }
+
+   search_stop_helpers();
 }
 
 // search_update_best()
@@ -286,7 +318,7 @@ void search_update_best() {
 
    search_update_current();
 
-   if (DispBest) {
+   if (DispBest && SearchInput->display) {
 
       move = SearchBest->move;
       value = SearchBest->value;
@@ -353,7 +385,7 @@ void search_update_root() {
    sint64 node_nb;
    char move_string[256];
 
-   if (DispRoot) {
+   if (DispRoot && SearchInput->display) {
 
       search_update_current();
 
@@ -380,14 +412,25 @@ void search_update_current() {
    my_timer_t *timer;
    sint64 node_nb;
    double time, speed, cpu;
+   int max_depth;
+   int i;
 
    timer = SearchCurrent->timer;
 
-   node_nb = SearchCurrent->node_nb;
+   node_nb = 0;
+   max_depth = 0;
+
+   for (i = 0; i < ThreadNb; i++) { // racy reads of the helper counters are fine for display
+      node_nb += SearchThread[i].node_nb;
+      if (SearchThread[i].max_depth > max_depth) max_depth = SearchThread[i].max_depth;
+   }
+
    time = (UseCpuTime) ? my_timer_elapsed_cpu(timer) : my_timer_elapsed_real(timer);
    speed = (time >= 1.0) ? double(node_nb) / time : 0.0;
    cpu = my_timer_cpu_usage(timer);
 
+   SearchCurrent->max_depth = max_depth;
+   SearchCurrent->node_nb = node_nb;
    SearchCurrent->time = time;
    SearchCurrent->speed = speed;
    SearchCurrent->cpu = cpu;
@@ -397,9 +440,14 @@ void search_update_current() {
 
 void search_check() {
 
+   if (SearchLocal->id != 0) { // helper thread: no I/O, no time control
+      if (HelperStop) longjmp(SearchLocal->buf,1);
+      return;
+   }
+
    search_send_stat();
 
-   if (UseEvent) event();
+   if (UseEvent && !SearchBench) event();
 
    if (SearchInput->depth_is_limited
     && SearchRoot->depth > SearchInput->depth_limit) {
@@ -434,7 +482,7 @@ static void search_send_stat() {
 
    search_update_current();
 
-   if (DispStat && SearchCurrent->time >= SearchInfo->last_time + 1.0) { // at least one-second gap
+   if (DispStat && SearchInput->display && SearchCurrent->time >= SearchInfo->last_time + 1.0) { // at least one-second gap
 
       SearchInfo->last_time = SearchCurrent->time;
 
@@ -449,5 +497,78 @@ static void search_send_stat() {
    }
 }
 
+// search_start_helpers()
+
+static void search_start_helpers() {
+
+   int i;
+
+   ASSERT(SearchLocal==&SearchThread[0]);
+
+   ThreadNb = option_get_int("Threads");
+   if (ThreadNb < 1) ThreadNb = 1;
+   if (ThreadNb > ThreadMax) ThreadNb = ThreadMax;
+
+   HelperStop = false;
+
+   for (i = 1; i < ThreadNb; i++) {
+      list_copy(SearchThread[i].list,SearchRoot->list);
+      my_thread_create(SearchThread[i].thread,search_helper,i);
+   }
+}
+
+// search_stop_helpers()
+
+static void search_stop_helpers() {
+
+   int i;
+
+   HelperStop = true;
+
+   for (i = 1; i < ThreadNb; i++) {
+      if (SearchThread[i].thread->handle != NULL) my_thread_join(SearchThread[i].thread);
+   }
+}
+
+// search_helper()
+
+static void search_helper(int id) {
+
+   search_thread_t * thread;
+   int depth;
+
+   ASSERT(id>0&&id<ThreadMax);
+
+   thread = &SearchThread[id];
+   SearchLocal = thread;
+
+   // private tables, the transposition table is shared
+
+   eval_alloc();
+   pawn_alloc();
+   material_alloc();
+   sort_clear();
+
+   if (setjmp(thread->buf) == 0) {
+
+      // lazy SMP: odd helpers run one iteration ahead of the main thread
+
+      for (depth = 1 + id % 2; depth < DepthMax && !HelperStop; depth++) {
+
+         board_copy(thread->board,SearchInput->board);
+
+         if (UseShortSearch && depth <= ShortSearchDepth) {
+            search_full_root(thread->list,thread->board,depth,SearchShort);
+         } else {
+            search_full_root(thread->list,thread->board,depth,SearchNormal);
+         }
+      }
+   }
+
+   eval_free();
+   pawn_free();
+   material_free();
+}
+
 // end of search.cpp
 
@@ -11,6 +11,7 @@
 #include "board.h"
 #include "list.h"
 #include "move.h"
+#include "posix.h"
 #include "util.h"
 
 // constants
@@ -18,6 +19,8 @@
 const int DepthMax = 64;
 const int HeightMax = 256;
 
+const int ThreadMax = 64;
+
 const int SearchNormal = 0;
 const int SearchShort  = 1;
 
@@ -37,13 +40,13 @@ struct search_input_t {
    bool time_is_limited;
    double time_limit_1;
    double time_limit_2;
+   bool display;
 };
 
 struct search_info_t {
    jmp_buf buf;
    bool can_stop;
    bool stop;
-   int check_nb;
    int check_inc;
    double last_time;
 };
@@ -80,6 +83,17 @@ struct search_current_t {
    double cpu;
 };
 
+struct search_thread_t {
+   jmp_buf buf;
+   board_t board[1];
+   list_t list[1];
+   my_thread_t thread[1];
+   int id; // 0 = main thread
+   int max_depth;
+   int check_nb;
+   sint64 node_nb;
+};
+
 // variables
 
 extern search_input_t SearchInput[1];
@@ -88,6 +102,11 @@ extern search_best_t SearchBest[1];
 extern search_root_t SearchRoot[1];
 extern search_current_t SearchCurrent[1];
 
+extern search_thread_t SearchThread[ThreadMax];
+extern THREAD_LOCAL search_thread_t * SearchLocal; // the calling thread
+
+extern bool SearchBench;
+
 // functions
 
 extern bool depth_is_ok           (int depth);
@@ -210,9 +210,9 @@ int search_full_root(list_t * list, board_t * board, int depth, int search_type)
    ASSERT(depth_is_ok(depth));
    ASSERT(search_type==SearchNormal||search_type==SearchShort);
 
-   ASSERT(list==SearchRoot->list);
+   ASSERT(list==SearchRoot->list||SearchLocal->id!=0);
    ASSERT(!LIST_IS_EMPTY(list));
-   ASSERT(board==SearchCurrent->board);
+   ASSERT(board==SearchCurrent->board||SearchLocal->id!=0);
    ASSERT(board_is_legal(board));
    ASSERT(depth>=1);
 
@@ -228,6 +228,7 @@ int search_full_root(list_t * list, board_t * board, int depth, int search_type)
 
 static int full_root(list_t * list, board_t * board, int alpha, int beta, int depth, int height, int search_type) {
 
+   bool main_thread;
    int old_alpha;
    int value, best_value;
    int i, move;
@@ -242,16 +243,18 @@ static int full_root(list_t * list, board_t * board, int alpha, int beta, int de
    ASSERT(height_is_ok(height));
    ASSERT(search_type==SearchNormal||search_type==SearchShort);
 
-   ASSERT(list==SearchRoot->list);
+   ASSERT(list==SearchRoot->list||SearchLocal->id!=0);
    ASSERT(!LIST_IS_EMPTY(list));
-   ASSERT(board==SearchCurrent->board);
+   ASSERT(board==SearchCurrent->board||SearchLocal->id!=0);
    ASSERT(board_is_legal(board));
    ASSERT(depth>=1);
 
    // init
 
-   SearchCurrent->node_nb++;
-   SearchInfo->check_nb--;
+   SearchLocal->node_nb++;
+   SearchLocal->check_nb--;
+
+   main_thread = SearchLocal->id == 0; // helpers do not report or drive time control
 
    for (i = 0; i < LIST_SIZE(list); i++) list->value[i] = ValueNone;
 
@@ -264,26 +267,33 @@ static int full_root(list_t * list, board_t * board, int alpha, int beta, int de
 
       move = LIST_MOVE(list,i);
 
-      SearchRoot->depth = depth;
-      SearchRoot->move = move;
-      SearchRoot->move_pos = i;
-      SearchRoot->move_nb = LIST_SIZE(list);
+      if (main_thread) {
+
+         SearchRoot->depth = depth;
+         SearchRoot->move = move;
+         SearchRoot->move_pos = i;
+         SearchRoot->move_nb = LIST_SIZE(list);
 
-      search_update_root();
+         search_update_root();
+      }
 
       new_depth = full_new_depth(depth,move,board,board_is_check(board)&&LIST_SIZE(list)==1,true);
 
       move_do(board,move,undo);
 
+      if (UseTrans && new_depth >= TransDepth) trans_prefetch(Trans,board->key);
+
       if (search_type == SearchShort || best_value == ValueNone) { // first move
          value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NodePV);
       } else { // other moves
          value = -full_search(board,-alpha-1,-alpha,new_depth,height+1,new_pv,NodeCut);
          if (value > alpha) { // && value < beta
-            SearchRoot->change = true;
-            SearchRoot->easy = false;
-            SearchRoot->flag = false;
-            search_update_root();
+            if (main_thread) {
+               SearchRoot->change = true;
+               SearchRoot->easy = false;
+               SearchRoot->flag = false;
+               search_update_root();
+            }
             value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NodePV);
          }
       }
@@ -298,7 +308,7 @@ static int full_root(list_t * list, board_t * board, int alpha, int beta, int de
          list->value[i] = value;
       }
 
-      if (value > best_value && (best_value == ValueNone || value > alpha)) {
+      if (main_thread && value > best_value && (best_value == ValueNone || value > alpha)) {
 
          SearchBest->move = move;
          SearchBest->value = value;
@@ -328,10 +338,10 @@ static int full_root(list_t * list, board_t * board, int alpha, int beta, int de
 
    list_sort(list);
 
-   ASSERT(SearchBest->move==LIST_MOVE(list,0));
-   ASSERT(SearchBest->value==best_value);
+   ASSERT(SearchBest->move==LIST_MOVE(list,0)||!main_thread);
+   ASSERT(SearchBest->value==best_value||!main_thread);
 
-   if (UseTrans && best_value > old_alpha && best_value < beta) {
+   if (main_thread && UseTrans && best_value > old_alpha && best_value < beta) {
       pv_fill(SearchBest->pv,board);
    }
 
@@ -375,14 +385,14 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
 
    // init
 
-   SearchCurrent->node_nb++;
-   SearchInfo->check_nb--;
+   SearchLocal->node_nb++;
+   SearchLocal->check_nb--;
    PV_CLEAR(pv);
 
-   if (height > SearchCurrent->max_depth) SearchCurrent->max_depth = height;
+   if (height > SearchLocal->max_depth) SearchLocal->max_depth = height;
 
-   if (SearchInfo->check_nb <= 0) {
-      SearchInfo->check_nb += SearchInfo->check_inc;
+   if (SearchLocal->check_nb <= 0) {
+      SearchLocal->check_nb += SearchInfo->check_inc;
       search_check();
    }
 
@@ -564,7 +574,7 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
             ASSERT(best_value!=ValueNone);
             ASSERT(played_nb>0);
             ASSERT(sort->pos>0&&move==LIST_MOVE(sort->list,sort->pos-1));
-            value = sort->value; // history score
+            value = sort_history(sort); // history score
             if (value < HistoryValue) {
                ASSERT(value>=0&&value<16384);
                ASSERT(move!=trans_move);
@@ -611,6 +621,8 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
 
       move_do(board,move,undo);
 
+      if (UseTrans && new_depth >= TransDepth) trans_prefetch(Trans,board->key);
+
       if (node_type != NodePV || best_value == ValueNone) { // first move
          value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NODE_OPP(node_type));
       } else { // other moves
@@ -727,14 +739,14 @@ static int full_no_null(board_t * board, int alpha, int beta, int depth, int hei
 
    // init
 
-   SearchCurrent->node_nb++;
-   SearchInfo->check_nb--;
+   SearchLocal->node_nb++;
+   SearchLocal->check_nb--;
    PV_CLEAR(pv);
 
-   if (height > SearchCurrent->max_depth) SearchCurrent->max_depth = height;
+   if (height > SearchLocal->max_depth) SearchLocal->max_depth = height;
 
-   if (SearchInfo->check_nb <= 0) {
-      SearchInfo->check_nb += SearchInfo->check_inc;
+   if (SearchLocal->check_nb <= 0) {
+      SearchLocal->check_nb += SearchInfo->check_inc;
       search_check();
    }
 
@@ -753,6 +765,7 @@ static int full_no_null(board_t * board, int alpha, int beta, int depth, int hei
       new_depth = full_new_depth(depth,move,board,false,false);
 
       move_do(board,move,undo);
+      if (UseTrans && new_depth >= TransDepth) trans_prefetch(Trans,board->key);
       value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NODE_OPP(node_type));
       move_undo(board,move,undo);
 
@@ -807,14 +820,14 @@ static int full_quiescence(board_t * board, int alpha, int beta, int depth, int
 
    // init
 
-   SearchCurrent->node_nb++;
-   SearchInfo->check_nb--;
+   SearchLocal->node_nb++;
+   SearchLocal->check_nb--;
    PV_CLEAR(pv);
 
-   if (height > SearchCurrent->max_depth) SearchCurrent->max_depth = height;
+   if (height > SearchLocal->max_depth) SearchLocal->max_depth = height;
 
-   if (SearchInfo->check_nb <= 0) {
-      SearchInfo->check_nb += SearchInfo->check_inc;
+   if (SearchLocal->check_nb <= 0) {
+      SearchLocal->check_nb += SearchInfo->check_inc;
       search_check();
    }
 
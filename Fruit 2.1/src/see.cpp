@@ -4,6 +4,7 @@
 // includes
 
 #include "attack.h"
+#include "bitboard.h"
 #include "board.h"
 #include "colour.h"
 #include "move.h"
@@ -252,6 +253,7 @@ static void alist_build(alist_t * alist, const board_t * board, int to, int colo
    int inc;
    int sq;
    int pawn;
+   uint64 attackers;
 
    ASSERT(alist!=NULL);
    ASSERT(board!=NULL);
@@ -260,24 +262,37 @@ static void alist_build(alist_t * alist, const board_t * board, int to, int colo
 
    // piece attacks
 
-   for (ptr = &board->piece[colour][0]; (from=*ptr) != SquareNone; ptr++) {
+   if (UseBitboard) {
 
-      piece = board->square[from];
-      delta = to - from;
+      // same piece-list order as below, so that SEE values are identical
 
-      if (PSEUDO_ATTACK(piece,delta)) {
+      attackers = attackers_to(board,to,colour);
 
-         inc = DELTA_INC_ALL(delta);
-         ASSERT(inc!=IncNone);
+      for (ptr = &board->piece[colour][0]; (from=*ptr) != SquareNone; ptr++) {
+         if ((attackers & SQUARE_BB(from)) != 0) alist_add(alist,from,board);
+      }
+
+   } else {
+
+      for (ptr = &board->piece[colour][0]; (from=*ptr) != SquareNone; ptr++) {
+
+         piece = board->square[from];
+         delta = to - from;
+
+         if (PSEUDO_ATTACK(piece,delta)) {
 
-         sq = from;
-         do {
-            sq += inc;
-            if (sq == to) { // attack
-               alist_add(alist,from,board);
-               break;
-            }
-         } while (board->square[sq] == Empty);
+            inc = DELTA_INC_ALL(delta);
+            ASSERT(inc!=IncNone);
+
+            sq = from;
+            do {
+               sq += inc;
+               if (sq == to) { // attack
+                  alist_add(alist,from,board);
+                  break;
+               }
+            } while (board->square[sq] == Empty);
+         }
       }
    }
 
@@ -299,6 +314,8 @@ static void alists_hidden(alists_t * alists, const board_t * board, int from, in
 
    int inc;
    int sq, piece;
+   int from_64, to_64;
+   uint64 occ, sliders;
 
    ASSERT(alists!=NULL);
    ASSERT(board!=NULL);
@@ -307,7 +324,37 @@ static void alists_hidden(alists_t * alists, const board_t * board, int from, in
 
    inc = DELTA_INC_LINE(to-from);
 
-   if (inc != IncNone) { // line
+   if (inc != IncNone && UseBitboard) { // line
+
+      // first slider behind "from", seen from "to"
+
+      from_64 = SQUARE_TO_64(from);
+      to_64 = SQUARE_TO_64(to);
+
+      occ = BOARD_OCC(board);
+
+      if ((INC_MASK(inc) & RookFlag) != 0) {
+         sliders = ROOK_ATTACK(from_64,occ) & (BOARD_BB(board,WhiteRook12) | BOARD_BB(board,BlackRook12) | BOARD_BB(board,WhiteQueen12) | BOARD_BB(board,BlackQueen12));
+      } else {
+         sliders = BISHOP_ATTACK(from_64,occ) & (BOARD_BB(board,WhiteBishop12) | BOARD_BB(board,BlackBishop12) | BOARD_BB(board,WhiteQueen12) | BOARD_BB(board,BlackQueen12));
+      }
+
+      for (; sliders != 0; sliders &= sliders - 1) {
+
+         if ((BETWEEN(bb_first(sliders),to_64) & BB_BIT(from_64)) != 0) {
+
+            sq = SQUARE_FROM_64(bb_first(sliders));
+            piece = board->square[sq];
+
+            ASSERT(piece_is_ok(piece));
+            ASSERT(SLIDER_ATTACK(piece,inc));
+
+            alist_add(alists->alist[PIECE_COLOUR(piece)],sq,board);
+            break;
+         }
+      }
+
+   } else if (inc != IncNone) { // line
 
       sq = from;
       do sq -= inc; while ((piece=board->square[sq]) == Empty);
@@ -13,6 +13,7 @@
 #include "move_gen.h"
 #include "move_legal.h"
 #include "piece.h"
+#include "protocol.h"
 #include "search.h"
 #include "see.h"
 #include "sort.h"
@@ -23,8 +24,8 @@
 
 static const int KillerNb = 2;
 
-static const int HistorySize = 12 * 64;
 static const int HistoryMax = 16384;
+static const int HistoryUnknown = -1; // sort->value before sort_history()
 
 static const int TransScore   = +32766;
 static const int GoodScore    =  +4000;
@@ -54,6 +55,23 @@ enum gen_t {
    GEN_END
 };
 
+struct history_t { // 8 bytes, never straddles a cache line
+   uint16 value;
+   uint16 hit;
+   uint16 tot;
+   uint16 pad;
+};
+
+struct sort_stat_t {
+   sint64 node_nb; // sort_init() and sort_init_qs() calls
+   sint64 gen_nb; // moves generated in scored stages (what a full sort touches)
+   sint64 score_nb; // move scores computed
+   sint64 pick_nb; // moves selected with list_select()
+   sint64 see_nb; // see_move() calls
+   sint64 quiet_nb; // quiet moves returned by sort_next()
+   sint64 prob_nb; // history_prob() calls
+};
+
 enum test_t {
    TEST_ERROR,
    TEST_NONE,
@@ -78,11 +96,13 @@ static int PosCaptureQS;
 
 static int Code[CODE_SIZE];
 
-static uint16 Killer[HeightMax][KillerNb];
+// per search thread
+
+static THREAD_LOCAL uint16 Killer[HeightMax][KillerNb];
 
-static uint16 History[HistorySize];
-static uint16 HistHit[HistorySize];
-static uint16 HistTot[HistorySize];
+static THREAD_LOCAL history_t History[12][64]; // [piece_12][to_64]
+
+static THREAD_LOCAL sort_stat_t SortStat[1];
 
 // prototypes
 
@@ -102,7 +122,7 @@ static bool capture_is_good   (int move, const board_t * board);
 
 static int  mvv_lva           (int move, const board_t * board);
 
-static int  history_index     (int move, const board_t * board);
+static history_t * history_entry (int move, const board_t * board);
 
 // functions
 
@@ -110,23 +130,11 @@ static int  history_index     (int move, const board_t * board);
 
 void sort_init() {
 
-   int i, height;
    int pos;
 
-   // killer
+   // killer and history
 
-   for (height = 0; height < HeightMax; height++) {
-      for (i = 0; i < KillerNb; i++) Killer[height][i] = MoveNone;
-   }
-
-   // history
-
-   for (i = 0; i < HistorySize; i++) History[i] = 0;
-
-   for (i = 0; i < HistorySize; i++) {
-      HistHit[i] = 1;
-      HistTot[i] = 1;
-   }
+   sort_clear();
 
    // Code[]
 
@@ -166,6 +174,65 @@ void sort_init() {
    ASSERT(pos<CODE_SIZE);
 }
 
+// sort_clear()
+
+void sort_clear() {
+
+   int i, height;
+   int piece, sq;
+
+   // killer
+
+   for (height = 0; height < HeightMax; height++) {
+      for (i = 0; i < KillerNb; i++) Killer[height][i] = MoveNone;
+   }
+
+   // history
+
+   for (piece = 0; piece < 12; piece++) {
+      for (sq = 0; sq < 64; sq++) {
+         History[piece][sq].value = 0;
+         History[piece][sq].hit = 1;
+         History[piece][sq].tot = 1;
+         History[piece][sq].pad = 0;
+      }
+   }
+
+   // statistics
+
+   SortStat->node_nb = 0;
+   SortStat->gen_nb = 0;
+   SortStat->score_nb = 0;
+   SortStat->pick_nb = 0;
+   SortStat->see_nb = 0;
+   SortStat->quiet_nb = 0;
+   SortStat->prob_nb = 0;
+}
+
+// sort_stats()
+
+void sort_stats() {
+
+   double node_nb;
+
+   // counters cover the period since the last report (calling thread only)
+
+   node_nb = (SortStat->node_nb != 0) ? double(SortStat->node_nb) : 1.0;
+
+   send("info string sort nodes " S64_FORMAT " generated %.2f scored %.2f picked %.2f see %.2f quiet %.2f history %.2f per node",
+        SortStat->node_nb,double(SortStat->gen_nb)/node_nb,double(SortStat->score_nb)/node_nb,
+        double(SortStat->pick_nb)/node_nb,double(SortStat->see_nb)/node_nb,
+        double(SortStat->quiet_nb)/node_nb,double(SortStat->prob_nb)/node_nb);
+
+   SortStat->node_nb = 0;
+   SortStat->gen_nb = 0;
+   SortStat->score_nb = 0;
+   SortStat->pick_nb = 0;
+   SortStat->see_nb = 0;
+   SortStat->quiet_nb = 0;
+   SortStat->prob_nb = 0;
+}
+
 // sort_init()
 
 void sort_init(sort_t * sort, board_t * board, const attack_t * attack, int depth, int height, int trans_killer) {
@@ -187,19 +254,24 @@ void sort_init(sort_t * sort, board_t * board, const attack_t * attack, int dept
    sort->killer_1 = Killer[sort->height][0];
    sort->killer_2 = Killer[sort->height][1];
 
+   SortStat->node_nb++;
+
    if (ATTACK_IN_CHECK(sort->attack)) {
 
       gen_legal_evasions(sort->list,sort->board,sort->attack);
       note_moves(sort->list,sort->board,sort->height,sort->trans_killer);
-      list_sort(sort->list);
+
+      SortStat->gen_nb += LIST_SIZE(sort->list);
 
       sort->gen = PosLegalEvasion + 1;
       sort->test = TEST_NONE;
+      sort->select = true;
 
    } else { // not in check
 
       LIST_CLEAR(sort->list);
       sort->gen = PosSEE;
+      sort->select = false;
    }
 
    sort->pos = 0;
@@ -220,6 +292,11 @@ int sort_next(sort_t * sort) {
 
          // next move
 
+         if (sort->select) {
+            list_select(sort->list,sort->pos);
+            SortStat->pick_nb++;
+         }
+
          move = LIST_MOVE(sort->list,sort->pos);
          sort->value = 16384; // default score
          sort->pos++;
@@ -277,7 +354,8 @@ int sort_next(sort_t * sort) {
             if (move == sort->killer_2) continue;
             if (!pseudo_is_legal(move,sort->board)) continue;
 
-            sort->value = history_prob(move,sort->board);
+            sort->value = HistoryUnknown; // only needed for history pruning, see sort_history()
+            SortStat->quiet_nb++;
 
          } else {
 
@@ -303,22 +381,26 @@ int sort_next(sort_t * sort) {
          if (sort->trans_killer != MoveNone) LIST_ADD(sort->list,sort->trans_killer);
 
          sort->test = TEST_TRANS_KILLER;
+         sort->select = false;
 
       } else if (gen == GEN_GOOD_CAPTURE) {
 
          gen_captures(sort->list,sort->board);
          note_mvv_lva(sort->list,sort->board);
-         list_sort(sort->list);
+
+         SortStat->gen_nb += LIST_SIZE(sort->list);
 
          LIST_CLEAR(sort->bad);
 
          sort->test = TEST_GOOD_CAPTURE;
+         sort->select = true;
 
       } else if (gen == GEN_BAD_CAPTURE) {
 
-         list_copy(sort->list,sort->bad);
+         list_copy(sort->list,sort->bad); // already in MVV/LVA order
 
          sort->test = TEST_BAD_CAPTURE;
+         sort->select = false;
 
       } else if (gen == GEN_KILLER) {
 
@@ -327,14 +409,17 @@ int sort_next(sort_t * sort) {
          if (sort->killer_2 != MoveNone) LIST_ADD(sort->list,sort->killer_2);
 
          sort->test = TEST_KILLER;
+         sort->select = false;
 
       } else if (gen == GEN_QUIET) {
 
          gen_quiet_moves(sort->list,sort->board);
          note_quiet_moves(sort->list,sort->board);
-         list_sort(sort->list);
+
+         SortStat->gen_nb += LIST_SIZE(sort->list);
 
          sort->test = TEST_QUIET;
+         sort->select = true;
 
       } else {
 
@@ -367,8 +452,28 @@ void sort_init_qs(sort_t * sort, board_t * board, const attack_t * attack, bool
       sort->gen = PosCaptureQS;
    }
 
+   SortStat->node_nb++;
+
    LIST_CLEAR(sort->list);
    sort->pos = 0;
+   sort->select = false;
+}
+
+// sort_history()
+
+int sort_history(sort_t * sort) {
+
+   ASSERT(sort!=NULL);
+   ASSERT(sort->pos>0);
+
+   // history score of the move just returned by sort_next(), computed on demand
+
+   if (sort->value == HistoryUnknown) {
+      sort->value = history_prob(LIST_MOVE(sort->list,sort->pos-1),sort->board);
+      SortStat->prob_nb++;
+   }
+
+   return sort->value;
 }
 
 // sort_next_qs()
@@ -386,6 +491,11 @@ int sort_next_qs(sort_t * sort) {
 
          // next move
 
+         if (sort->select) {
+            list_select(sort->list,sort->pos);
+            SortStat->pick_nb++;
+         }
+
          move = LIST_MOVE(sort->list,sort->pos);
          sort->pos++;
 
@@ -411,6 +521,7 @@ int sort_next_qs(sort_t * sort) {
             ASSERT(!move_is_tactical(move,sort->board));
             ASSERT(move_is_check(move,sort->board));
 
+            SortStat->see_nb++;
             if (see_move(move,sort->board) < 0) continue;
             if (!pseudo_is_legal(move,sort->board)) continue;
 
@@ -436,23 +547,28 @@ int sort_next_qs(sort_t * sort) {
 
          gen_pseudo_evasions(sort->list,sort->board,sort->attack);
          note_moves_simple(sort->list,sort->board);
-         list_sort(sort->list);
+
+         SortStat->gen_nb += LIST_SIZE(sort->list);
 
          sort->test = TEST_LEGAL;
+         sort->select = true;
 
       } else if (gen == GEN_CAPTURE_QS) {
 
          gen_captures(sort->list,sort->board);
          note_mvv_lva(sort->list,sort->board);
-         list_sort(sort->list);
+
+         SortStat->gen_nb += LIST_SIZE(sort->list);
 
          sort->test = TEST_CAPTURE_QS;
+         sort->select = true;
 
       } else if (gen == GEN_CHECK_QS) {
 
          gen_quiet_checks(sort->list,sort->board);
 
          sort->test = TEST_CHECK_QS;
+         sort->select = false;
 
       } else {
 
@@ -469,8 +585,8 @@ int sort_next_qs(sort_t * sort) {
 
 void good_move(int move, const board_t * board, int depth, int height) {
 
-   int index;
-   int i;
+   history_t * entry;
+   int piece, sq;
 
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
@@ -491,13 +607,15 @@ void good_move(int move, const board_t * board, int depth, int height) {
 
    // history
 
-   index = history_index(move,board);
+   entry = history_entry(move,board);
 
-   History[index] += HISTORY_INC(depth);
+   entry->value += HISTORY_INC(depth);
 
-   if (History[index] >= HistoryMax) {
-      for (i = 0; i < HistorySize; i++) {
-         History[i] = (History[i] + 1) / 2;
+   if (entry->value >= HistoryMax) {
+      for (piece = 0; piece < 12; piece++) {
+         for (sq = 0; sq < 64; sq++) {
+            History[piece][sq].value = (History[piece][sq].value + 1) / 2;
+         }
       }
    }
 }
@@ -506,7 +624,7 @@ void good_move(int move, const board_t * board, int depth, int height) {
 
 void history_good(int move, const board_t * board) {
 
-   int index;
+   history_t * entry;
 
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
@@ -515,25 +633,25 @@ void history_good(int move, const board_t * board) {
 
    // history
 
-   index = history_index(move,board);
+   entry = history_entry(move,board);
 
-   HistHit[index]++;
-   HistTot[index]++;
+   entry->hit++;
+   entry->tot++;
 
-   if (HistTot[index] >= HistoryMax) {
-      HistHit[index] = (HistHit[index] + 1) / 2;
-      HistTot[index] = (HistTot[index] + 1) / 2;
+   if (entry->tot >= HistoryMax) {
+      entry->hit = (entry->hit + 1) / 2;
+      entry->tot = (entry->tot + 1) / 2;
    }
 
-   ASSERT(HistHit[index]<=HistTot[index]);
-   ASSERT(HistTot[index]<HistoryMax);
+   ASSERT(entry->hit<=entry->tot);
+   ASSERT(entry->tot<HistoryMax);
 }
 
 // history_bad()
 
 void history_bad(int move, const board_t * board) {
 
-   int index;
+   history_t * entry;
 
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
@@ -542,17 +660,17 @@ void history_bad(int move, const board_t * board) {
 
    // history
 
-   index = history_index(move,board);
+   entry = history_entry(move,board);
 
-   HistTot[index]++;
+   entry->tot++;
 
-   if (HistTot[index] >= HistoryMax) {
-      HistHit[index] = (HistHit[index] + 1) / 2;
-      HistTot[index] = (HistTot[index] + 1) / 2;
+   if (entry->tot >= HistoryMax) {
+      entry->hit = (entry->hit + 1) / 2;
+      entry->tot = (entry->tot + 1) / 2;
    }
 
-   ASSERT(HistHit[index]<=HistTot[index]);
-   ASSERT(HistTot[index]<HistoryMax);
+   ASSERT(entry->hit<=entry->tot);
+   ASSERT(entry->tot<HistoryMax);
 }
 
 // note_moves()
@@ -574,6 +692,7 @@ void note_moves(list_t * list, const board_t * board, int height, int trans_kill
          move = LIST_MOVE(list,i);
          list->value[i] = move_value(move,board,height,trans_killer);
       }
+      SortStat->score_nb += size;
    }
 }
 
@@ -594,6 +713,7 @@ static void note_captures(list_t * list, const board_t * board) {
          move = LIST_MOVE(list,i);
          list->value[i] = capture_value(move,board);
       }
+      SortStat->score_nb += size;
    }
 }
 
@@ -614,6 +734,7 @@ static void note_quiet_moves(list_t * list, const board_t * board) {
          move = LIST_MOVE(list,i);
          list->value[i] = quiet_move_value(move,board);
       }
+      SortStat->score_nb += size;
    }
 }
 
@@ -634,6 +755,7 @@ static void note_moves_simple(list_t * list, const board_t * board) {
          move = LIST_MOVE(list,i);
          list->value[i] = move_value_simple(move,board);
       }
+      SortStat->score_nb += size;
    }
 }
 
@@ -654,6 +776,7 @@ static void note_mvv_lva(list_t * list, const board_t * board) {
          move = LIST_MOVE(list,i);
          list->value[i] = mvv_lva(move,board);
       }
+      SortStat->score_nb += size;
    }
 }
 
@@ -713,16 +836,13 @@ static int capture_value(int move, const board_t * board) {
 static int quiet_move_value(int move, const board_t * board) {
 
    int value;
-   int index;
 
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
 
    ASSERT(!move_is_tactical(move,board));
 
-   index = history_index(move,board);
-
-   value = HistoryScore + History[index];
+   value = HistoryScore + history_entry(move,board)->value;
    ASSERT(value>=HistoryScore&&value<=KillerScore-4);
 
    return value;
@@ -748,19 +868,19 @@ static int move_value_simple(int move, const board_t * board) {
 static int history_prob(int move, const board_t * board) {
 
    int value;
-   int index;
+   const history_t * entry;
 
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
 
    ASSERT(!move_is_tactical(move,board));
 
-   index = history_index(move,board);
+   entry = history_entry(move,board);
 
-   ASSERT(HistHit[index]<=HistTot[index]);
-   ASSERT(HistTot[index]<HistoryMax);
+   ASSERT(entry->hit<=entry->tot);
+   ASSERT(entry->tot<HistoryMax);
 
-   value = (HistHit[index] * 16384) / HistTot[index];
+   value = (entry->hit * 16384) / entry->tot;
    ASSERT(value>=0&&value<=16384);
 
    return value;
@@ -798,6 +918,8 @@ static bool capture_is_good(int move, const board_t * board) {
       if (VALUE_PIECE(capture) >= VALUE_PIECE(piece)) return true;
    }
 
+   SortStat->see_nb++;
+
    return see_move(move,board) >= 0;
 }
 
@@ -839,22 +961,16 @@ static int mvv_lva(int move, const board_t * board) {
    return value;
 }
 
-// history_index()
-
-static int history_index(int move, const board_t * board) {
+// history_entry()
 
-   int index;
+static history_t * history_entry(int move, const board_t * board) {
 
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
 
    ASSERT(!move_is_tactical(move,board));
 
-   index = PIECE_TO_12(board->square[MOVE_FROM(move)]) * 64 + SQUARE_TO_64(MOVE_TO(move));
-
-   ASSERT(index>=0&&index<HistorySize);
-
-   return index;
+   return &History[PIECE_TO_12(board->square[MOVE_FROM(move)])][SQUARE_TO_64(MOVE_TO(move))];
 }
 
 // end of sort.cpp
@@ -23,6 +23,7 @@ struct sort_t {
    int test;
    int pos;
    int value;
+   bool select; // list is scored, pick the best move lazily
    board_t * board;
    const attack_t * attack;
    list_t list[1];
@@ -32,9 +33,12 @@ struct sort_t {
 // functions
 
 extern void sort_init    ();
+extern void sort_clear   ();
+extern void sort_stats   ();
 
 extern void sort_init    (sort_t * sort, board_t * board, const attack_t * attack, int depth, int height, int trans_killer);
 extern int  sort_next    (sort_t * sort);
+extern int  sort_history (sort_t * sort);
 
 extern void sort_init_qs (sort_t * sort, board_t * board, const attack_t * attack, bool check);
 extern int  sort_next_qs (sort_t * sort);
@@ -3,9 +3,14 @@
 
 // includes
 
+#if defined(_MSC_VER)
+#  include <xmmintrin.h>
+#endif
+
 #include "hash.h"
 #include "move.h"
 #include "option.h"
+#include "posix.h"
 #include "protocol.h"
 #include "trans.h"
 #include "util.h"
@@ -16,13 +21,21 @@
 #define MIN(a,b) ((a)<=(b)?(a):(b))
 #define MAX(a,b) ((a)>=(b)?(a):(b))
 
+#if defined(_MSC_VER)
+#  define PREFETCH(address) _mm_prefetch((const char *)(address),_MM_HINT_T0)
+#elif defined(__GNUC__)
+#  define PREFETCH(address) __builtin_prefetch(address)
+#else
+#  define PREFETCH(address)
+#endif
+
 // constants
 
 static const bool UseModulo = false;
 
 static const int DateSize = 16;
 
-static const int ClusterSize = 4; // TODO: unsigned?
+static const int ClusterSize = 4; // 4 x 16 bytes = one 64-byte cache line
 
 static const int DepthNone = -128;
 
@@ -43,11 +56,12 @@ struct entry_t {
 
 struct trans { // HACK: typedef'ed in trans.h
    entry_t * table;
-   uint32 size;
-   uint32 mask;
+   uint64 size; // entries
+   uint64 mask; // clusters - 1
+   bool large; // large pages obtained?
    int date;
    int age[DateSize];
-   uint32 used;
+   uint64 used;
    sint64 read_nb;
    sint64 read_hit;
    sint64 write_nb;
@@ -101,6 +115,7 @@ void trans_init(trans_t * trans) {
    trans->size = 0;
    trans->mask = 0;
    trans->table = NULL;
+   trans->large = false;
 
    trans_set_date(trans,0);
 
@@ -113,7 +128,7 @@ void trans_init(trans_t * trans) {
 
 void trans_alloc(trans_t * trans) {
 
-   uint32 size, target;
+   uint64 size, target;
 
    ASSERT(trans!=NULL);
 
@@ -133,11 +148,14 @@ void trans_alloc(trans_t * trans) {
 
    size /= sizeof(entry_t);
    ASSERT(size!=0&&(size&(size-1))==0); // power of 2
+   ASSERT(size>=uint64(ClusterSize));
+
+   trans->size = size;
+   trans->mask = size / ClusterSize - 1;
 
-   trans->size = size + (ClusterSize - 1); // HACK to avoid testing for end of table
-   trans->mask = size - 1;
+   // clusters never straddle cache lines
 
-   trans->table = (entry_t *) my_malloc(trans->size*sizeof(entry_t));
+   trans->table = (entry_t *) my_aligned_alloc(trans->size*sizeof(entry_t),option_get_bool("Large Pages"),&trans->large);
 
    trans_clear(trans);
 
@@ -150,11 +168,12 @@ void trans_free(trans_t * trans) {
 
    ASSERT(trans_is_ok(trans));
 
-   my_free(trans->table);
+   my_aligned_free(trans->table);
 
    trans->table = NULL;
    trans->size = 0;
    trans->mask = 0;
+   trans->large = false;
 }
 
 // trans_clear()
@@ -163,7 +182,7 @@ void trans_clear(trans_t * trans) {
 
    entry_t clear_entry[1];
    entry_t * entry;
-   uint32 index;
+   uint64 index;
 
    ASSERT(trans!=NULL);
 
@@ -385,30 +404,47 @@ bool trans_retrieve(trans_t * trans, uint64 key, int * move, int * min_depth, in
    return false;
 }
 
+// trans_prefetch()
+
+void trans_prefetch(trans_t * trans, uint64 key) {
+
+   ASSERT(trans_is_ok(trans));
+
+   PREFETCH(trans_entry(trans,key));
+}
+
 // trans_stats()
 
 void trans_stats(const trans_t * trans) {
 
    double full;
-   // double hit, collision;
+   double hit, update, collision;
 
    ASSERT(trans_is_ok(trans));
 
+   // counters are reset by trans_inc_date(), i.e. they cover the current search
+
    full = double(trans->used) / double(trans->size);
-   // hit = double(trans->read_hit) / double(trans->read_nb);
-   // collision = double(trans->write_collision) / double(trans->write_nb);
+   hit = (trans->read_nb != 0) ? double(trans->read_hit) / double(trans->read_nb) : 0.0;
+   update = (trans->write_nb != 0) ? double(trans->write_hit) / double(trans->write_nb) : 0.0;
+   collision = (trans->write_nb != 0) ? double(trans->write_collision) / double(trans->write_nb) : 0.0;
 
    send("info hashfull %.0f",full*1000.0);
+   send("info string hash " S64_FORMAT "MB%s reads " S64_FORMAT " hit %.1f%% writes " S64_FORMAT " update %.1f%% collision %.1f%%",
+        sint64(trans->size*sizeof(entry_t)/(1024*1024)),(trans->large)?" large pages":"",
+        trans->read_nb,hit*100.0,trans->write_nb,update*100.0,collision*100.0);
 }
 
 // trans_entry()
 
 static entry_t * trans_entry(trans_t * trans, uint64 key) {
 
-   uint32 index;
+   uint64 index;
 
    ASSERT(trans_is_ok(trans));
 
+   // cluster index, KEY_INDEX() covers up to 2^32 clusters (256 GB)
+
    if (UseModulo) {
       index = KEY_INDEX(key) % (trans->mask + 1);
    } else {
@@ -417,7 +453,7 @@ static entry_t * trans_entry(trans_t * trans, uint64 key) {
 
    ASSERT(index<=trans->mask);
 
-   return &trans->table[index];
+   return &trans->table[index*ClusterSize];
 }
 
 // entry_is_ok()
@@ -41,6 +41,12 @@
 #  define U64(u) (u##ULL)
 #endif
 
+#ifdef _MSC_VER
+#  define THREAD_LOCAL __declspec(thread)
+#else
+#  define THREAD_LOCAL __thread
+#endif
+
 #undef ASSERT
 #if DEBUG
 #  define ASSERT(a) { if (!(a)) my_fatal("file \"%s\", line %d, assertion \"" #a "\" failed\n",__FILE__,__LINE__); }
@@ -27,7 +27,7 @@
 #include <string>
 #include <sstream>
 
-#include "movepick.h"
+#include "movegen.h"
 #include "san.h"
 
 
@@ -52,6 +52,9 @@ namespace {
   /// Functions
 
   Ambiguity move_ambiguity(Position &pos, Move m);
+  int legal_moves_to(Position &pos, PieceType pt, Square to,
+                     PieceType promotion, Move mlist[]);
+  bool evasion_is_legal(Position &pos, Move m);
   const std::string time_string(int milliseconds);
   const std::string score_string(Value v);
 }
@@ -153,27 +156,32 @@ const std::string move_to_san(Position &pos, Move m) {
 /// interpret the string as a move in short algebraic notation.  On success,
 /// the move is returned.  On failure (i.e. if the string is unparsable, or
 /// if the move is illegal or ambiguous), MOVE_NONE is returned.
+///
+/// No move generation is done: the origin squares are found directly from
+/// the attack bitboards of the destination square, and only these few
+/// candidates are tested for legality.
 
 Move move_from_san(Position &pos, const std::string &movestr) {
   assert(pos.is_ok());
 
-  MovePicker mp = MovePicker(pos, false, MOVE_NONE, MOVE_NONE, MOVE_NONE,
-                             MOVE_NONE, OnePly);
+  Color us = pos.side_to_move();
 
   // Castling moves
-  if(movestr == "O-O-O") {
+  if(movestr == "O-O-O" || movestr == "O-O") {
     Move m;
-    while((m = mp.get_next_move()) != MOVE_NONE)
-      if(move_is_long_castle(m) && pos.move_is_legal(m))
-        return m;
-    return MOVE_NONE;
-  }
-  else if(movestr == "O-O") {
-    Move m;
-    while((m = mp.get_next_move()) != MOVE_NONE)
-      if(move_is_short_castle(m) && pos.move_is_legal(m))
-        return m;
-    return MOVE_NONE;
+    if(pos.is_check())
+      return MOVE_NONE;
+    if(movestr == "O-O-O") {
+      if(!pos.can_castle_queenside(us))
+        return MOVE_NONE;
+      m = make_castle_move(pos.king_square(us), pos.initial_qr_square(us));
+    }
+    else {
+      if(!pos.can_castle_kingside(us))
+        return MOVE_NONE;
+      m = make_castle_move(pos.king_square(us), pos.initial_kr_square(us));
+    }
+    return generate_move_if_legal(pos, m, pos.pinned_pieces(us));
   }
 
   // Normal moves
@@ -200,7 +208,7 @@ Move move_from_san(Position &pos, const std::string &movestr) {
   Rank fromRank = RANK_NONE;
 
   // Promotion?
-  if(strchr("BNRQ", str[right])) {
+  if(right >= 0 && strchr("BNRQ", str[right])) {
     promotion = piece_type_from_char(str[right]);
     right--;
   }
@@ -238,26 +246,19 @@ Move move_from_san(Position &pos, const std::string &movestr) {
       fromRank = rank_from_char(str[left]);
   }
 
-  // Look for a matching move:
-  Move m, move = MOVE_NONE;
-  int matches = 0;
-
-  while((m = mp.get_next_move()) != MOVE_NONE) {
-    bool match = true;
-    if(pos.type_of_piece_on(move_from(m)) != pt)
-      match = false;
-    else if(move_to(m) != to)
-      match = false;
-    else if(move_promotion(m) != promotion)
-      match = false;
-    else if(fromFile != FILE_NONE && fromFile != square_file(move_from(m)))
-      match = false;
-    else if(fromRank != RANK_NONE && fromRank != square_rank(move_from(m)))
-      match = false;
-    if(match) {
-      move = m;
-      matches++;
-    }
+  // Look for a matching move among the legal moves to the destination
+  // square:
+  Move mlist[16], move = MOVE_NONE;
+  int n, matches = 0;
+
+  n = legal_moves_to(pos, pt, to, promotion, mlist);
+  for(i = 0; i < n; i++) {
+    if(fromFile != FILE_NONE && fromFile != square_file(move_from(mlist[i])))
+      continue;
+    if(fromRank != RANK_NONE && fromRank != square_rank(move_from(mlist[i])))
+      continue;
+    move = mlist[i];
+    matches++;
   }
 
   if(matches == 1)
@@ -358,16 +359,10 @@ namespace {
     if(type_of_piece(pc) == KING)
       return AMBIGUITY_NONE;
 
-    MovePicker mp = MovePicker(pos, false, MOVE_NONE, MOVE_NONE, MOVE_NONE,
-                               MOVE_NONE, OnePly);
-    Move mv, moveList[8];
+    Move moveList[16];
     int i, j, n;
 
-    n = 0;
-    while((mv = mp.get_next_move()) != MOVE_NONE)
-      if(move_to(mv) == to && pos.piece_on(move_from(mv)) == pc
-         && pos.move_is_legal(mv))
-        moveList[n++] = mv;
+    n = legal_moves_to(pos, type_of_piece(pc), to, NO_PIECE_TYPE, moveList);
     if(n == 1)
       return AMBIGUITY_NONE;
 
@@ -389,6 +384,101 @@ namespace {
   }
 
 
+  /// legal_moves_to() finds all legal moves of pieces of type 'pt' for the
+  /// side to move to the square 'to', with the given promotion piece type.
+  /// The candidate origin squares are found with attack bitboards from the
+  /// destination square, and only these are tested for legality.  The moves
+  /// are stored in mlist[], and their number is returned.
+
+  int legal_moves_to(Position &pos, PieceType pt, Square to,
+                     PieceType promotion, Move mlist[]) {
+    Color us = pos.side_to_move(), them = opposite_color(us);
+    Bitboard b;
+    Square from;
+    int n = 0;
+
+    if(pos.color_of_piece_on(to) == us)
+      return 0;
+
+    if(pt == PAWN) {
+      // No pawn move ends on the first rank, and the origin square below
+      // would be off the board:
+      if(pawn_rank(us, to) == RANK_1)
+        return 0;
+
+      // A pawn move to the last rank must be a promotion, and only a pawn
+      // move to the last rank can be a promotion:
+      if((pawn_rank(us, to) == RANK_8) != (promotion != NO_PIECE_TYPE))
+        return 0;
+
+      if(pos.color_of_piece_on(to) == them || to == pos.ep_square())
+        b = pos.pawn_attacks(them, to) & pos.pawns(us);
+      else {
+        b = EmptyBoardBB;
+        from = to - pawn_push(us);
+        if(pos.piece_on(from) == pawn_of_color(us))
+          set_bit(&b, from);
+        else if(pos.square_is_empty(from) && pawn_rank(us, to) == RANK_4
+                && pos.piece_on(from - pawn_push(us)) == pawn_of_color(us))
+          set_bit(&b, from - pawn_push(us));
+      }
+    }
+    else {
+      if(promotion != NO_PIECE_TYPE)
+        return 0;
+
+      switch(pt) {
+      case KNIGHT: b = pos.knight_attacks(to); break;
+      case BISHOP: b = pos.bishop_attacks(to); break;
+      case ROOK:   b = pos.rook_attacks(to); break;
+      case QUEEN:  b = pos.queen_attacks(to); break;
+      case KING:   b = pos.king_attacks(to); break;
+      default:     return 0;
+      }
+      b &= pos.pieces_of_color_and_type(us, pt);
+    }
+
+    if(!b)
+      return 0;
+
+    // When in check, Position::move_is_legal() assumes that the move is
+    // an evasion, so we test by making the move instead:
+    Bitboard pinned = pos.is_check()? EmptyBoardBB : pos.pinned_pieces(us);
+
+    while(b) {
+      Move m;
+
+      from = pop_1st_bit(&b);
+      if(pt == PAWN && to == pos.ep_square())
+        m = make_ep_move(from, to);
+      else if(promotion != NO_PIECE_TYPE)
+        m = make_promotion_move(from, to, promotion);
+      else
+        m = make_move(from, to);
+
+      if(pos.is_check()? evasion_is_legal(pos, m) : pos.move_is_legal(m, pinned))
+        mlist[n++] = m;
+    }
+    return n;
+  }
+
+
+  /// evasion_is_legal() tests whether a pseudo-legal move leaves the king of
+  /// the side to move in check.
+
+  bool evasion_is_legal(Position &pos, Move m) {
+    Color us = pos.side_to_move();
+    UndoInfo u;
+    bool legal;
+
+    pos.do_move(m, u);
+    legal = !pos.square_is_attacked(pos.king_square(us), opposite_color(us));
+    pos.undo_move(m, u);
+
+    return legal;
+  }
+
+
   const std::string time_string(int milliseconds) {
     std::stringstream s;
 
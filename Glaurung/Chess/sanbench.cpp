@@ -0,0 +1,408 @@
+/*
+  Glaurung, a UCI chess playing engine.
+  Copyright (C) 2004-2010 Tord Romstad, Marco Costalba, Joona Kiiski.
+
+  Glaurung is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Glaurung is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+  sanbench.cpp is a command line benchmark for move_from_san().  It is not
+  part of the app target; build it from the Chess directory with
+
+    g++ -O2 -DNDEBUG -o sanbench *.cpp
+
+  and run it as "sanbench <file.pgn>".
+*/
+
+
+////
+//// Includes
+////
+
+#include <cassert>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bitboard.h"
+#include "direction.h"
+#include "mersenne.h"
+#include "misc.h"
+#include "movepick.h"
+#include "san.h"
+
+
+////
+//// Local definitions
+////
+
+namespace Chess {
+
+namespace {
+
+  /// Functions
+
+  void san_benchmark(const std::string &fileName);
+  Move move_from_san_movepicker(Position &pos, const std::string &movestr);
+  bool read_pgn(const std::string &fileName,
+                std::vector<std::vector<std::string> > &games);
+}
+
+}
+
+using namespace Chess;
+
+
+////
+//// Functions
+////
+
+int main(int argc, char *argv[]) {
+  if(argc != 2) {
+    std::cout << "Usage: sanbench <file.pgn>" << std::endl;
+    return 1;
+  }
+
+  init_mersenne();
+  init_direction_table();
+  init_bitboards();
+  Position::init_zobrist();
+  Position::init_piece_square_tables();
+  MovePicker::init_phase_table();
+
+  san_benchmark(argv[1]);
+  return 0;
+}
+
+
+namespace Chess {
+
+namespace {
+
+  /// san_benchmark() measures how fast the moves of a PGN file are decoded.
+  /// Every game is replayed twice, once with move_from_san() and once with
+  /// the old MovePicker based decoder, and the number of SAN moves decoded
+  /// per second is printed for both.  The time needed to merely replay the
+  /// decoded moves is measured separately and subtracted.  Any disagreement
+  /// between the two decoders is reported.  Games are read from the initial
+  /// position or from their FEN tag; variations, comments and NAGs are
+  /// skipped.
+
+  void san_benchmark(const std::string &fileName) {
+    std::vector<std::vector<std::string> > games;
+    std::vector<Move> moves;
+    Position pos;
+    UndoInfo u;
+    int errors = 0, mismatches = 0;
+    int t, replayTime, newTime, oldTime;
+    uint64_t n = 0;
+
+    if(!read_pgn(fileName, games)) {
+      std::cout << "Unable to open file " << fileName << std::endl;
+      return;
+    }
+
+    // The first string of every game is the FEN of the initial position.
+    // Decode all games once, checking the new decoder against the old one
+    // and remembering the moves for the replay pass.
+    for(unsigned g = 0; g < games.size(); g++) {
+      pos.from_fen(games[g][0]);
+      for(unsigned i = 1; i < games[g].size(); i++) {
+        Move m = move_from_san(pos, games[g][i]);
+        if(m != move_from_san_movepicker(pos, games[g][i]))
+          mismatches++;
+        if(m == MOVE_NONE) {
+          errors++;
+          break;
+        }
+        moves.push_back(m);
+        pos.do_move(m, u);
+        if(pos.rule_50_counter() == 0)
+          pos.reset_game_ply();
+        n++;
+      }
+      moves.push_back(MOVE_NONE);
+    }
+
+    // Replay only:
+    t = get_system_time();
+    for(unsigned g = 0, k = 0; g < games.size(); g++, k++) {
+      pos.from_fen(games[g][0]);
+      for( ; moves[k] != MOVE_NONE; k++) {
+        pos.do_move(moves[k], u);
+        if(pos.rule_50_counter() == 0)
+          pos.reset_game_ply();
+      }
+    }
+    replayTime = get_system_time() - t;
+
+    // Decode and replay, new decoder:
+    t = get_system_time();
+    for(unsigned g = 0; g < games.size(); g++) {
+      pos.from_fen(games[g][0]);
+      for(unsigned i = 1; i < games[g].size(); i++) {
+        Move m = move_from_san(pos, games[g][i]);
+        if(m == MOVE_NONE)
+          break;
+        pos.do_move(m, u);
+        if(pos.rule_50_counter() == 0)
+          pos.reset_game_ply();
+      }
+    }
+    newTime = get_system_time() - t - replayTime;
+
+    // Decode and replay, MovePicker decoder:
+    t = get_system_time();
+    for(unsigned g = 0; g < games.size(); g++) {
+      pos.from_fen(games[g][0]);
+      for(unsigned i = 1; i < games[g].size(); i++) {
+        Move m = move_from_san_movepicker(pos, games[g][i]);
+        if(m == MOVE_NONE)
+          break;
+        pos.do_move(m, u);
+        if(pos.rule_50_counter() == 0)
+          pos.reset_game_ply();
+      }
+    }
+    oldTime = get_system_time() - t - replayTime;
+
+    std::cout << "Games:               " << games.size() << std::endl
+              << "SAN moves:           " << n << std::endl
+              << "Illegal moves:       " << errors << std::endl
+              << "Decoder mismatches:  " << mismatches << std::endl
+              << "Replay time (ms):    " << replayTime << std::endl
+              << "move_from_san:       " << newTime << " ms, "
+              << (n * 1000) / Max(newTime, 1) << " moves/second" << std::endl
+              << "MovePicker decoder:  " << oldTime << " ms, "
+              << (n * 1000) / Max(oldTime, 1) << " moves/second" << std::endl;
+  }
+
+
+  /// move_from_san_movepicker() is the old implementation of move_from_san(),
+  /// which goes through all moves returned by a MovePicker.  It is only kept
+  /// here as a reference for san_benchmark().
+
+  Move move_from_san_movepicker(Position &pos, const std::string &movestr) {
+    assert(pos.is_ok());
+
+    MovePicker mp = MovePicker(pos, false, MOVE_NONE, MOVE_NONE, MOVE_NONE,
+                               MOVE_NONE, OnePly);
+
+    // Castling moves
+    if(movestr == "O-O-O") {
+      Move m;
+      while((m = mp.get_next_move()) != MOVE_NONE)
+        if(move_is_long_castle(m) && pos.move_is_legal(m))
+          return m;
+      return MOVE_NONE;
+    }
+    else if(movestr == "O-O") {
+      Move m;
+      while((m = mp.get_next_move()) != MOVE_NONE)
+        if(move_is_short_castle(m) && pos.move_is_legal(m))
+          return m;
+      return MOVE_NONE;
+    }
+
+    // Normal moves
+    const char *cstr = movestr.c_str();
+    const char *c;
+    char *cc;
+    char str[10];
+    int i;
+
+    // Initialize str[] by making a copy of movestr with the characters
+    // 'x', '=', '+' and '#' removed.
+    cc = str;
+    for(i=0, c=cstr; i<10 && *c!='\0' && *c!='\n' && *c!=' '; i++, c++)
+      if(!strchr("x=+#", *c)) {
+        *cc = strchr("nrq", *c)? toupper(*c) : *c;
+        cc++;
+      }
+    *cc = '\0';
+
+    int left = 0, right = strlen(str) - 1;
+    PieceType pt = NO_PIECE_TYPE, promotion;
+    Square to;
+    File fromFile = FILE_NONE;
+    Rank fromRank = RANK_NONE;
+
+    // Promotion?
+    if(strchr("BNRQ", str[right])) {
+      promotion = piece_type_from_char(str[right]);
+      right--;
+    }
+    else
+      promotion = NO_PIECE_TYPE;
+
+    // Find the moving piece:
+    if(left < right) {
+      if(strchr("BNRQK", str[left])) {
+        pt = piece_type_from_char(str[left]);
+        left++;
+      }
+      else
+        pt = PAWN;
+    }
+
+    // Find the to square:
+    if(left < right) {
+      if(str[right] < '1' || str[right] > '8' ||
+         str[right-1] < 'a' || str[right-1] > 'h')
+        return MOVE_NONE;
+      to = make_square(file_from_char(str[right-1]), rank_from_char(str[right]));
+      right -= 2;
+    }
+    else
+      return MOVE_NONE;
+
+    // Find the file and/or rank of the from square:
+    if(left <= right) {
+      if(strchr("abcdefgh", str[left])) {
+        fromFile = file_from_char(str[left]);
+        left++;
+      }
+      if(strchr("12345678", str[left]))
+        fromRank = rank_from_char(str[left]);
+    }
+
+    // Look for a matching move:
+    Move m, move = MOVE_NONE;
+    int matches = 0;
+
+    while((m = mp.get_next_move()) != MOVE_NONE) {
+      bool match = true;
+      if(pos.type_of_piece_on(move_from(m)) != pt)
+        match = false;
+      else if(move_to(m) != to)
+        match = false;
+      else if(move_promotion(m) != promotion)
+        match = false;
+      else if(fromFile != FILE_NONE && fromFile != square_file(move_from(m)))
+        match = false;
+      else if(fromRank != RANK_NONE && fromRank != square_rank(move_from(m)))
+        match = false;
+      if(match) {
+        move = m;
+        matches++;
+      }
+    }
+
+    if(matches == 1)
+      return move;
+    else
+      return MOVE_NONE;
+  }
+
+
+  /// read_pgn() reads all games of a PGN file.  Each game is stored as a
+  /// vector of strings: the FEN of the initial position, followed by the
+  /// SAN moves of the main line.  Returns false if the file can't be opened.
+
+  bool read_pgn(const std::string &fileName,
+                std::vector<std::vector<std::string> > &games) {
+    std::ifstream f(fileName.c_str());
+    std::string line, token;
+    std::vector<std::string> game;
+    int ravDepth = 0;
+    bool inComment = false;
+
+    if(!f.is_open())
+      return false;
+
+    while(std::getline(f, line)) {
+      // Tag pairs.  A new tag section starts a new game, unless the current
+      // game has no moves yet.
+      if(!inComment && ravDepth == 0 && !line.empty() && line[0] == '[') {
+        if(game.size() > 1) {
+          games.push_back(game);
+          game.clear();
+        }
+        if(game.empty())
+          game.push_back(StartPosition);
+        if(line.compare(0, 6, "[FEN \"") == 0) {
+          std::string::size_type e = line.find('"', 6);
+          if(e != std::string::npos)
+            game[0] = line.substr(6, e - 6);
+        }
+        continue;
+      }
+
+      for(std::string::size_type i = 0; i < line.size(); ) {
+        char ch = line[i];
+
+        if(inComment) {
+          if(ch == '}')
+            inComment = false;
+          i++;
+        }
+        else if(ch == '{') {
+          inComment = true;
+          i++;
+        }
+        else if(ch == ';')
+          break;
+        else if(ch == '(') {
+          ravDepth++;
+          i++;
+        }
+        else if(ch == ')') {
+          ravDepth--;
+          i++;
+        }
+        else if(isspace(ch))
+          i++;
+        else {
+          std::string::size_type j = i;
+          while(j < line.size() && !isspace(line[j]) && !strchr("{;()", line[j]))
+            j++;
+          token = line.substr(i, j - i);
+          i = j;
+
+          if(ravDepth > 0 || token[0] == '$')
+            continue; // Variation or NAG
+
+          if(token == "1-0" || token == "0-1" || token == "1/2-1/2"
+             || token == "*") {
+            if(game.size() > 1)
+              games.push_back(game);
+            game.clear();
+            continue;
+          }
+
+          // Strip move numbers like "12." or "12...":
+          token.erase(0, token.find_first_not_of("0123456789."));
+          if(token.empty())
+            continue;
+
+          if(game.empty())
+            game.push_back(StartPosition);
+          std::string::size_type k = token.find_last_not_of("!?");
+          game.push_back(token.substr(0, k + 1));
+        }
+      }
+    }
+    if(game.size() > 1)
+      games.push_back(game);
+
+    return true;
+  }
+
+}
+
+}
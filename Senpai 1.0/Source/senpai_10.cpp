@@ -32,7 +32,9 @@
 
 // C++ includes
 
+#include <deque>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -40,11 +42,21 @@
 
 // C++11 includes
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <thread>
 
+// system includes
+
+#ifdef _WIN32
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#endif
+
 // macros
 
 #ifdef _MSC_VER
@@ -149,6 +161,10 @@ public:
    void signal () { p_cond.notify_one(); }
 };
 
+int64 nanoseconds() { // for profiling counters
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 int round(double x) {
    return int(std::floor(x + 0.5));
 }
@@ -231,15 +247,61 @@ void log(const std::string & s) {
    log_file << s << std::endl;
 }
 
+void * alloc_large(uint64 size, bool & large) { // cache-line aligned, huge pages if possible
+
+#ifdef _WIN32
+
+   void * mem = NULL;
+
+   if (large && GetLargePageMinimum() != 0) {
+      uint64 page = GetLargePageMinimum();
+      mem = VirtualAlloc(NULL, SIZE_T((size + page - 1) / page * page), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE); // needs SeLockMemoryPrivilege
+   }
+
+   large = mem != NULL;
+   if (mem == NULL) mem = VirtualAlloc(NULL, SIZE_T(size), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+#else
+
+   const uint64 page = U64(2) << 20;
+
+   void * mem = NULL;
+   large = large && size >= page;
+   if (posix_memalign(&mem, large ? page : 64, size) != 0) mem = NULL;
+
+#  ifdef MADV_HUGEPAGE
+   if (large && mem != NULL) large = madvise(mem, size, MADV_HUGEPAGE) == 0; // transparent huge pages
+#  else
+   large = false;
+#  endif
+
+#endif
+
+   if (mem == NULL) {
+      std::cerr << "out of memory" << std::endl;
+      std::exit(EXIT_FAILURE);
+   }
+
+   return mem;
+}
+
+void free_large(void * mem) {
+#ifdef _WIN32
+   VirtualFree(mem, 0, MEM_RELEASE);
+#else
+   std::free(mem);
+#endif
+}
+
 }
 
 namespace input {
 
-class Input : public util::Waitable {
+class Input : public util::Waitable { // line queue filled by the input thread
 
-   bool volatile p_has_input;
+   std::atomic<bool> p_has_input; // mailbox flag, polled without locking
    bool p_eof;
-   std::string p_line;
+   std::deque<std::string> p_lines;
 
 public:
 
@@ -249,22 +311,25 @@ public:
    }
 
    bool has_input() const {
-      return p_has_input;
+      return p_has_input.load(std::memory_order_relaxed);
    }
 
    bool get_line(std::string & line) {
 
       lock();
 
-      while (!p_has_input) {
+      while (p_lines.empty() && !p_eof) {
          wait();
       }
 
-      bool line_ok = !p_eof;
-      if (line_ok) line = p_line;
+      bool line_ok = !p_lines.empty();
 
-      p_has_input = false;
-      signal();
+      if (line_ok) {
+         line = p_lines.front();
+         p_lines.pop_front();
+      }
+
+      p_has_input.store(!p_lines.empty() || p_eof, std::memory_order_relaxed);
 
       unlock();
 
@@ -275,13 +340,9 @@ public:
 
       lock();
 
-      while (p_has_input) {
-         wait();
-      }
-
       p_eof = true;
 
-      p_has_input = true;
+      p_has_input.store(true, std::memory_order_release);
       signal();
 
       unlock();
@@ -291,13 +352,9 @@ public:
 
       lock();
 
-      while (p_has_input) {
-         wait();
-      }
-
-      p_line = line;
+      p_lines.push_back(line);
 
-      p_has_input = true;
+      p_has_input.store(true, std::memory_order_release);
       signal();
 
       unlock();
@@ -1049,8 +1106,20 @@ int phase(int pc) {
 
 }
 
+namespace attack { // HACK: early declaration for incremental attack tables
+
+bit_t attacks_from(int pc, int sd, int f, bit_t all);
+
+}
+
 namespace board {
 
+const int ATTACK_OFF   = 0; // attacks are computed from the bitboards when needed
+const int ATTACK_ON    = 1; // per-square attack tables updated by move() and undo()
+const int ATTACK_CHECK = 2; // same, verified against full recomputation after every update
+
+int attack_mode = ATTACK_OFF; // read by clear(), i.e. when a new position is set up
+
 struct Copy {
    hash_t key;
    hash_t pawn_key;
@@ -1091,6 +1160,91 @@ private:
    int p_sp;
    Undo p_stack[1024];
 
+   int p_attack_mode;
+   bit_t p_attack_from[square::SIZE]; // squares attacked by the piece on each square
+   bit_t p_attack_to[square::SIZE];   // pieces of both sides attacking each square
+   int8 p_attack_count[side::SIZE][square::SIZE];
+
+   void add_attacks(int sd, int f, bit_t ts) {
+
+      for (bit_t b = ts; b != 0; b = bit::rest(b)) {
+         int t = bit::first(b);
+         p_attack_count[sd][t]++;
+         bit::set(p_attack_to[t], f);
+      }
+   }
+
+   void remove_attacks(int sd, int f, bit_t ts) {
+
+      for (bit_t b = ts; b != 0; b = bit::rest(b)) {
+         int t = bit::first(b);
+         assert(p_attack_count[sd][t] > 0);
+         p_attack_count[sd][t]--;
+         bit::clear(p_attack_to[t], f);
+      }
+   }
+
+   void update_sliders(int sq) { // sq changed occupancy: only the rays of sliders attacking it move
+
+      bit_t all = p_side[side::WHITE] | p_side[side::BLACK];
+      bit_t sliders = p_piece[piece::BISHOP] | p_piece[piece::ROOK] | p_piece[piece::QUEEN];
+
+      for (bit_t b = p_attack_to[sq] & sliders; b != 0; b = bit::rest(b)) {
+
+         int f = bit::first(b);
+         int sd = square_side(f);
+
+         bit_t old_ts = p_attack_from[f];
+         bit_t new_ts = attack::attacks_from(p_square[f], sd, f, all);
+
+         remove_attacks(sd, f, old_ts & ~new_ts);
+         add_attacks(sd, f, new_ts & ~old_ts);
+
+         p_attack_from[f] = new_ts;
+      }
+   }
+
+   bool attacks_ok() const { // full recomputation
+
+      bit_t all = p_side[side::WHITE] | p_side[side::BLACK];
+
+      bit_t attack_to[square::SIZE];
+      int count[side::SIZE][square::SIZE];
+
+      for (int sq = 0; sq < square::SIZE; sq++) {
+         attack_to[sq] = 0;
+         count[side::WHITE][sq] = 0;
+         count[side::BLACK][sq] = 0;
+      }
+
+      for (int f = 0; f < square::SIZE; f++) {
+
+         if (p_square[f] == piece::NONE) {
+            if (p_attack_from[f] != 0) return false;
+            continue;
+         }
+
+         int sd = square_side(f);
+         bit_t ts = attack::attacks_from(p_square[f], sd, f, all);
+
+         if (p_attack_from[f] != ts) return false;
+
+         for (bit_t b = ts; b != 0; b = bit::rest(b)) {
+            int t = bit::first(b);
+            count[sd][t]++;
+            bit::set(attack_to[t], f);
+         }
+      }
+
+      for (int sq = 0; sq < square::SIZE; sq++) {
+         if (p_attack_to[sq] != attack_to[sq]) return false;
+         if (p_attack_count[side::WHITE][sq] != count[side::WHITE][sq]) return false;
+         if (p_attack_count[side::BLACK][sq] != count[side::BLACK][sq]) return false;
+      }
+
+      return true;
+   }
+
 public:
 
    void operator=(const Board & bd) {
@@ -1124,6 +1278,18 @@ public:
          p_stack[sp] = bd.p_stack[sp];
       }
 
+      p_attack_mode = bd.p_attack_mode;
+
+      if (p_attack_mode != ATTACK_OFF) {
+
+         for (int sq = 0; sq < square::SIZE; sq++) {
+            p_attack_from[sq] = bd.p_attack_from[sq];
+            p_attack_to[sq] = bd.p_attack_to[sq];
+            p_attack_count[side::WHITE][sq] = bd.p_attack_count[side::WHITE][sq];
+            p_attack_count[side::BLACK][sq] = bd.p_attack_count[side::BLACK][sq];
+         }
+      }
+
       assert(moves() == bd.moves());
    }
 
@@ -1234,6 +1400,26 @@ public:
       return (p_sp == 0) ? move::NONE : p_stack[p_sp - 1].move;
    }
 
+   bool has_attacks() const {
+      return p_attack_mode != ATTACK_OFF;
+   }
+
+   int attack_count(int sd, int sq) const {
+      assert(has_attacks());
+      return p_attack_count[sd][sq];
+   }
+
+   bit_t attackers(int sq) const { // both sides, including pawns
+      assert(has_attacks());
+      return p_attack_to[sq];
+   }
+
+   bit_t piece_attacks(int sq) const {
+      assert(has_attacks());
+      assert(p_square[sq] != piece::NONE);
+      return p_attack_from[sq];
+   }
+
    bool is_draw() const {
 
       if (p_copy.moves > 100) { // TODO: check for mate
@@ -1257,6 +1443,40 @@ public:
       p_root = p_sp;
    }
 
+   int path(int moves[]) const { // moves from the search root (including null moves)
+
+      for (int sp = p_root; sp < p_sp; sp++) {
+         moves[sp - p_root] = p_stack[sp].move;
+      }
+
+      return p_sp - p_root;
+   }
+
+   void set_path(const int moves[], int size) { // same root; keeps the common prefix, undoes and replays the rest
+
+      int common = 0;
+
+      while (common < size && p_root + common < p_sp && p_stack[p_root + common].move == moves[common]) {
+         common++;
+      }
+
+      while (p_sp > p_root + common) {
+         if (p_stack[p_sp - 1].move == move::NULL_) {
+            undo_null();
+         } else {
+            undo();
+         }
+      }
+
+      for (int i = common; i < size; i++) {
+         if (moves[i] == move::NULL_) {
+            move_null();
+         } else {
+            move(moves[i]);
+         }
+      }
+   }
+
    void clear() {
 
       for (int pc = 0; pc < piece::SIZE; pc++) {
@@ -1291,6 +1511,15 @@ public:
 
       p_root = 0;
       p_sp = 0;
+
+      p_attack_mode = attack_mode;
+
+      for (int sq = 0; sq < square::SIZE; sq++) {
+         p_attack_from[sq] = 0;
+         p_attack_to[sq] = 0;
+         p_attack_count[side::WHITE][sq] = 0;
+         p_attack_count[side::BLACK][sq] = 0;
+      }
    }
 
    void clear_square(int pc, int sd, int sq, bool update_copy) {
@@ -1301,6 +1530,11 @@ public:
 
       assert(pc == p_square[sq]);
 
+      if (p_attack_mode != ATTACK_OFF) {
+         remove_attacks(sd, sq, p_attack_from[sq]);
+         p_attack_from[sq] = 0;
+      }
+
       assert(bit::is_set(p_piece[pc], sq));
       bit::clear(p_piece[pc], sq);
 
@@ -1315,6 +1549,10 @@ public:
       assert(p_count[p12] != 0);
       p_count[p12]--;
 
+      if (p_attack_mode != ATTACK_OFF) {
+         update_sliders(sq);
+      }
+
       if (update_copy) {
 
          hash_t key = hash::piece_key(p12, sq);
@@ -1348,6 +1586,13 @@ public:
 
       p_count[p12]++;
 
+      if (p_attack_mode != ATTACK_OFF) {
+         update_sliders(sq);
+         bit_t ts = attack::attacks_from(pc, sd, sq, p_side[side::WHITE] | p_side[side::BLACK]);
+         add_attacks(sd, sq, ts);
+         p_attack_from[sq] = ts;
+      }
+
       if (update_copy) {
 
          hash_t key = hash::piece_key(p12, sq);
@@ -1372,6 +1617,11 @@ public:
 
       p_all = p_side[side::WHITE] | p_side[side::BLACK];
 
+      if (p_attack_mode == ATTACK_CHECK && !attacks_ok()) {
+         std::cerr << "attack tables out of sync after move " << last_move() << std::endl;
+         std::exit(EXIT_FAILURE);
+      }
+
 #ifdef DEBUG
 
       for (int p12 = 0; p12 < piece::SIDE_SIZE; p12++) {
@@ -1864,13 +2114,13 @@ bit_t pawn_attacks_to(int sd, int t) {
    return pawn_attacks_from(side::opposit(sd), t);
 }
 
-bit_t piece_attacks_from(int pc, int f, const board::Board & bd) {
+bit_t piece_attacks_from(int pc, int f, bit_t all) {
 
    assert(pc != piece::PAWN);
 
    bit_t ts = Piece_Attacks[pc][f];
 
-   for (bit_t b = bd.all() & Blockers[pc][f]; b != 0; b = bit::rest(b)) {
+   for (bit_t b = all & Blockers[pc][f]; b != 0; b = bit::rest(b)) {
       int sq = bit::first(b);
       ts &= ~Behind[f][sq];
    }
@@ -1878,6 +2128,10 @@ bit_t piece_attacks_from(int pc, int f, const board::Board & bd) {
    return ts;
 }
 
+bit_t piece_attacks_from(int pc, int f, const board::Board & bd) {
+   return piece_attacks_from(pc, f, bd.all());
+}
+
 bit_t piece_attacks_to(int pc, int t, const board::Board & bd) {
    assert(pc != piece::PAWN);
    return piece_attacks_from(pc, t, bd);
@@ -1900,6 +2154,14 @@ bit_t attacks_from(int pc, int sd, int f, const board::Board & bd) {
    }
 }
 
+bit_t attacks_from(int pc, int sd, int f, bit_t all) {
+   if (pc == piece::PAWN) {
+      return Pawn_Attacks[sd][f];
+   } else {
+      return piece_attacks_from(pc, f, all);
+   }
+}
+
 bit_t attacks_to(int pc, int sd, int t, const board::Board & bd) {
    return attacks_from(pc, side::opposit(sd), t, bd); // HACK for pawns
 }
@@ -1949,6 +2211,10 @@ bool attack_behind(int f, int t, int sd, const board::Board & bd) {
 
 bool is_attacked(int t, int sd, const board::Board & bd) {
 
+   if (bd.has_attacks()) {
+      return bd.attack_count(sd, t) != 0;
+   }
+
    // non-sliders
 
    if ((bd.piece(piece::PAWN, sd) & Pawn_Attacks[side::opposit(sd)][t]) != 0) { // HACK
@@ -2006,6 +2272,37 @@ void init_attacks(Attacks & attacks, int sd, const board::Board & bd) { // for s
    attacks.avoid  = 0;
    attacks.pinned = 0;
 
+   if (bd.has_attacks()) { // checkers from the tables, only x-rays need a scan
+
+      bit_t checkers = bd.attackers(t) & bd.side(atk);
+      bit_t sliders = bd.piece(piece::BISHOP) | bd.piece(piece::ROOK) | bd.piece(piece::QUEEN);
+
+      if ((checkers & ~sliders) != 0) {
+         assert(bit::single(checkers & ~sliders));
+         attacks.square[attacks.size++] = bit::first(checkers & ~sliders);
+      }
+
+      for (bit_t b = checkers & sliders; b != 0; b = bit::rest(b)) {
+         int f = bit::first(b);
+         assert(attacks.size < 2);
+         attacks.square[attacks.size++] = f;
+         attacks.avoid |= ray(f, t);
+      }
+
+      for (bit_t b = slider_pseudo_attacks_to(atk, t, bd) & ~checkers; b != 0; b = bit::rest(b)) {
+
+         int f = bit::first(b);
+
+         bit_t bb = bd.all() & Between[f][t];
+
+         if (bit::single(bb)) {
+            attacks.pinned |= bb;
+         }
+      }
+
+      return;
+   }
+
    // non-sliders
 
    {
@@ -2300,6 +2597,23 @@ public:
       move_to(pos, 0);
    }
 
+   int select(int pos) { // partial selection sort: brings the best remaining move to pos
+
+      assert(pos < p_size);
+
+      int bp = pos;
+
+      for (int i = pos + 1; i < p_size; i++) {
+         if (p_pair[i] > p_pair[bp]) bp = i;
+      }
+
+      uint32 p = p_pair[bp];
+      p_pair[bp] = p_pair[pos];
+      p_pair[pos] = p;
+
+      return move(pos);
+   }
+
    void sort() { // insertion sort
 
       for (int i = 1; i < p_size; i++) {
@@ -2977,48 +3291,74 @@ int flags(int sc, int alpha, int beta) {
 
 namespace trans {
 
+// entries are written as two 64-bit words from many threads without locking;
+// the lock is stored XORed with the data so that torn writes fail verification
+
 struct Entry { // 16 bytes
-   uint32 lock;
-   uint32 move; // TODO: uint16 #
-   uint16 pad_1;
-   int16 score;
-   uint8 date;
-   int8 depth;
-   uint8 flags;
-   uint8 pad_2;
+   uint64 check; // lock ^ data
+   uint64 data;  // move:24 score:16 date:8 depth:8 flags:8
+};
+
+struct Bucket { // 64 bytes = one cache line
+   Entry entry[4];
 };
 
+uint64 make_data(int move, int score, int date, int depth, int flags) {
+
+   assert(move >= 0 && move < (1 << 24));
+   assert(date >= 0 && date < 256);
+   assert(depth >= -1 && depth < 100);
+
+   return uint64(move)
+        | (uint64(uint16(score)) << 24)
+        | (uint64(date)          << 40)
+        | (uint64(uint8(depth))  << 48)
+        | (uint64(flags)         << 56);
+}
+
+int data_move  (uint64 data) { return int(data & 0xFFFFFF); }
+int data_score (uint64 data) { return int16(data >> 24); }
+int data_date  (uint64 data) { return int(uint8(data >> 40)); }
+int data_depth (uint64 data) { return int8(data >> 48); }
+int data_flags (uint64 data) { return int(uint8(data >> 56)); }
+
 void clear_entry(Entry & entry) {
 
    assert(sizeof(Entry) == 16);
+   assert(sizeof(Bucket) == 64);
+
+   entry.data = make_data(move::NONE, 0, 0, -1, score::FLAGS_NONE);
+   entry.check = entry.data ^ (uint64(1) << 63); // check ^ data has a bit above the 32-bit lock, so no key matches
+}
+
+bool entry_match(const Entry & entry, uint32 lock) {
+   return (entry.check ^ entry.data) == lock;
+}
 
-   entry.lock = 0;
-   entry.move = move::NONE;
-   entry.pad_1 = 0;
-   entry.score = 0;
-   entry.date = 0;
-   entry.depth = -1;
-   entry.flags = score::FLAGS_NONE;
-   entry.pad_2 = 0;
+void write_entry(Entry & entry, uint32 lock, uint64 data) {
+   entry.check = lock ^ data;
+   entry.data = data;
 }
 
 class Table {
 
 private:
 
-   Entry * p_table;
+   Bucket * p_table;
    int p_bits;
-   uint64 p_size;
+   uint64 p_size; // in buckets
    uint64 p_mask;
 
+   bool p_large_pages; // requested
+   bool p_large;       // obtained
+
    int p_date;
-   uint64 p_used;
 
    int size_to_bits(int size) {
 
       int bits = 0;
 
-      for (uint64 entries = (uint64(size) << 20) / sizeof(Entry); entries > 1; entries /= 2) {
+      for (uint64 buckets = (uint64(size) << 20) / sizeof(Bucket); buckets > 1; buckets /= 2) {
          bits++;
       }
 
@@ -3034,8 +3374,10 @@ public:
       p_size = 1;
       p_mask = 0;
 
+      p_large_pages = true;
+      p_large = false;
+
       p_date = 0;
-      p_used = 0;
    }
 
    void set_size(int size) {
@@ -3053,15 +3395,28 @@ public:
       }
    }
 
+   void set_large_pages(bool large_pages) {
+
+      if (large_pages == p_large_pages) return;
+
+      p_large_pages = large_pages;
+
+      if (p_table != NULL) {
+         free();
+         alloc();
+      }
+   }
+
    void alloc() {
       assert(p_table == NULL);
-      p_table = new Entry[p_size];
+      p_large = p_large_pages;
+      p_table = static_cast<Bucket *>(util::alloc_large(p_size * sizeof(Bucket), p_large));
       clear();
    }
 
    void free() {
       assert(p_table != NULL);
-      delete [] p_table;
+      util::free_large(p_table);
       p_table = NULL;
    }
 
@@ -3071,16 +3426,16 @@ public:
       clear_entry(e);
 
       for (uint64 i = 0; i < p_size; i++) {
-         p_table[i] = e;
+         for (int j = 0; j < 4; j++) {
+            p_table[i].entry[j] = e;
+         }
       }
 
       p_date = 1;
-      p_used = 0;
    }
 
    void inc_date() {
       p_date = (p_date + 1) % 256;
-      p_used = 0;
    }
 
    void store(hash_t key, int depth, int ply, int move, int score, int flags) {
@@ -3091,39 +3446,35 @@ public:
 
       score = score::to_trans(score, ply);
 
-      uint64 index = hash::index(key) & p_mask;
-      uint32 lock  = hash::lock(key);
+      Bucket & bucket = p_table[hash::index(key) & p_mask];
+      uint32 lock = hash::lock(key);
 
       Entry * be = NULL;
       int bs = -1;
 
-      for (uint64 i = 0; i < 4; i++) {
+      for (int i = 0; i < 4; i++) {
 
-         uint64 idx = (index + i) & p_mask;
-         assert(idx < p_size);
-         Entry & entry = p_table[idx];
+         Entry & entry = bucket.entry[i];
+         Entry e = entry; // snapshot, other threads may be writing
 
-         if (entry.lock == lock) {
+         if (entry_match(e, lock)) {
 
-            if (entry.date != p_date) {
-               entry.date = p_date;
-               p_used++;
-            }
+            int e_move = data_move(e.data);
+            int e_depth = data_depth(e.data);
 
-            if (depth >= entry.depth) {
-               if (move != move::NONE) entry.move = move;
-               entry.depth = depth;
-               entry.score = score;
-               entry.flags = flags;
-            } else if (entry.move == move::NONE) {
-               entry.move = move;
+            if (depth >= e_depth) {
+               if (move != move::NONE) e_move = move;
+               write_entry(entry, lock, make_data(e_move, score, p_date, depth, flags));
+            } else if (e_move == move::NONE || data_date(e.data) != p_date) {
+               if (e_move == move::NONE) e_move = move;
+               write_entry(entry, lock, make_data(e_move, data_score(e.data), p_date, e_depth, data_flags(e.data)));
             }
 
             return;
          }
 
-         int sc = 99 - entry.depth; // NOTE: entry.depth can be -1
-         if (entry.date != p_date) sc += 101;
+         int sc = 99 - data_depth(e.data); // NOTE: depth can be -1
+         if (data_date(e.data) != p_date) sc += 101;
          assert(sc >= 0 && sc < 202);
 
          if (sc > bs) {
@@ -3134,41 +3485,34 @@ public:
 
       assert(be != NULL);
 
-      if (be->date != p_date) p_used++;
-
-      be->lock = lock;
-      be->date = p_date;
-      be->move = move;
-      be->depth = depth;
-      be->score = score;
-      be->flags = flags;
+      write_entry(*be, lock, make_data(move, score, p_date, depth, flags));
    }
 
    bool retrieve(hash_t key, int depth, int ply, int & move, int & score, int & flags) {
 
       assert(depth >= 0 && depth < 100);
 
-      uint64 index = hash::index(key) & p_mask;
-      uint32 lock  = hash::lock(key);
+      Bucket & bucket = p_table[hash::index(key) & p_mask];
+      uint32 lock = hash::lock(key);
 
-      for (uint64 i = 0; i < 4; i++) {
+      for (int i = 0; i < 4; i++) {
 
-         uint64 idx = (index + i) & p_mask;
-         assert(idx < p_size);
-         Entry & entry = p_table[idx];
+         Entry & entry = bucket.entry[i];
+         Entry e = entry; // snapshot, other threads may be writing
 
-         if (entry.lock == lock) {
+         if (entry_match(e, lock)) {
 
-            if (entry.date != p_date) {
-               entry.date = p_date; // touch entry
-               p_used++;
+            if (data_date(e.data) != p_date) { // touch entry
+               uint64 data = e.data;
+               data = (data & ~(U64(0xFF) << 40)) | (uint64(p_date) << 40);
+               write_entry(entry, lock, data);
             }
 
-            move = entry.move;
-            score = score::from_trans(entry.score, ply);
-            flags = entry.flags;
+            move = data_move(e.data);
+            score = score::from_trans(data_score(e.data), ply);
+            flags = data_flags(e.data);
 
-            if (entry.depth >= depth) {
+            if (data_depth(e.data) >= depth) {
                return true;
             } else if (score::is_mate(score)) {
                flags &= ~(score < 0 ? score::FLAGS_LOWER : score::FLAGS_UPPER);
@@ -3182,8 +3526,23 @@ public:
       return false;
    }
 
-   int used() const {
-      return int((p_used * 1000 + p_size / 2) / p_size);
+   int used() const { // estimate from a sample, no shared counter
+
+      uint64 size = std::min(p_size, U64(250));
+      int used = 0;
+
+      for (uint64 i = 0; i < size; i++) {
+         for (int j = 0; j < 4; j++) {
+            const Entry & entry = p_table[i].entry[j];
+            if (data_date(entry.data) == p_date && data_depth(entry.data) >= 0) used++;
+         }
+      }
+
+      return int((used * 1000 + size * 2) / (size * 4));
+   }
+
+   bool large_pages() const {
+      return p_large;
    }
 
 };
@@ -3197,6 +3556,8 @@ struct Engine {
    bool ponder;
    int threads;
    bool log;
+   bool large_pages;
+   bool local_history;
 };
 
 Engine engine;
@@ -3206,6 +3567,8 @@ void init() {
    engine.ponder = false;
    engine.threads = 1;
    engine.log = false;
+   engine.large_pages = true;
+   engine.local_history = true;
 }
 
 }
@@ -3310,6 +3673,8 @@ private:
 
       int sd = p_side;
 
+      bit_t direct = p_board->has_attacks() ? p_board->attackers(p_to) : 0; // clear lines in the initial position
+
       for (int pc = piece::PAWN; pc <= piece::KING; pc++) {
 
          bit_t fs = p_board->piece(pc, sd) & attack::pseudo_attacks_to(pc, sd, p_to) & p_all;
@@ -3318,7 +3683,7 @@ private:
 
             int f = bit::first(b);
 
-            if ((p_all & attack::Between[f][p_to]) == 0) {
+            if (bit::is_set(direct, f) || (p_all & attack::Between[f][p_to]) == 0) {
                return f;
             }
          }
@@ -3610,7 +3975,14 @@ private:
    static const int PROB_HALF  = 1 << (PROB_BIT - 1);
    static const int PROB_SHIFT = 5;
 
-   int p_prob[piece::SIDE_SIZE * square::SIZE];
+   static const int SIZE = piece::SIDE_SIZE * square::SIZE;
+
+   // relaxed atomics: concurrent updates may be lost but never torn
+   // cache-line aligned so that a shared table doesn't share lines with its neighbours
+   alignas(64) std::atomic<int> p_prob[SIZE];
+
+   int get(int idx) const { return p_prob[idx].load(std::memory_order_relaxed); }
+   void set(int idx, int prob) { p_prob[idx].store(prob, std::memory_order_relaxed); }
 
    static int index(int mv, const board::Board & bd) {
 
@@ -3628,22 +4000,44 @@ private:
    void update_good(int mv, const board::Board & bd) {
       if (!move::is_tactical(mv)) {
          int idx = index(mv, bd);
-         p_prob[idx] += (PROB_ONE - p_prob[idx]) >> PROB_SHIFT;
+         int prob = get(idx);
+         set(idx, prob + ((PROB_ONE - prob) >> PROB_SHIFT));
       }
    }
 
    void update_bad(int mv, const board::Board & bd) {
       if (!move::is_tactical(mv)) {
          int idx = index(mv, bd);
-         p_prob[idx] -= p_prob[idx] >> PROB_SHIFT;
+         int prob = get(idx);
+         set(idx, prob - (prob >> PROB_SHIFT));
       }
    }
 
 public:
 
    void clear() {
-      for (int idx = 0; idx < piece::SIDE_SIZE * square::SIZE; idx++) {
-         p_prob[idx] = PROB_HALF;
+      for (int idx = 0; idx < SIZE; idx++) {
+         set(idx, PROB_HALF);
+      }
+   }
+
+   static void merge(History * table[], int size) { // average thread-local tables and share the result
+
+      assert(size > 0);
+
+      for (int idx = 0; idx < SIZE; idx++) {
+
+         int sum = 0;
+
+         for (int i = 0; i < size; i++) {
+            sum += table[i]->get(idx);
+         }
+
+         int prob = (sum + size / 2) / size;
+
+         for (int i = 0; i < size; i++) {
+            table[i]->set(idx, prob);
+         }
       }
    }
 
@@ -3661,7 +4055,7 @@ public:
 
    int score(int mv, const board::Board & bd) const {
       int idx = index(mv, bd);
-      return p_prob[idx];
+      return get(idx);
    }
 
 };
@@ -3734,37 +4128,33 @@ int evasion_score(int mv, int trans_move) {
    return sc;
 }
 
-void sort_tacticals(gen::List & ml) {
+// scoring only, moves are selected incrementally with gen::List::select()
+
+void score_tacticals(gen::List & ml) {
 
    for (int pos = 0; pos < ml.size(); pos++) {
       int mv = ml.move(pos);
       int sc = tactical_score(mv);
       ml.set_score(pos, sc);
    }
-
-   ml.sort();
 }
 
-void sort_history(gen::List & ml, const board::Board & bd, const History & history) {
+void score_history(gen::List & ml, const board::Board & bd, const History & history) {
 
    for (int pos = 0; pos < ml.size(); pos++) {
       int mv = ml.move(pos);
       int sc = history.score(mv, bd);
       ml.set_score(pos, sc);
    }
-
-   ml.sort();
 }
 
-void sort_evasions(gen::List & ml, int trans_move) {
+void score_evasions(gen::List & ml, int trans_move) {
 
    for (int pos = 0; pos < ml.size(); pos++) {
       int mv = ml.move(pos);
       int sc = evasion_score(mv, trans_move);
       ml.set_score(pos, sc);
    }
-
-   ml.sort();
 }
 
 }
@@ -3795,6 +4185,39 @@ const Inst Prog_QS_Root[] = { GEN_TRANS, POST_KILLER, GEN_TACTICAL, POST_MOVE, G
 const Inst Prog_QS[]      = { GEN_TRANS, POST_KILLER, GEN_TACTICAL, POST_MOVE, GEN_END };
 const Inst Prog_Evasion[] = { GEN_EVASION, POST_MOVE_SEE, GEN_BAD, POST_BAD, GEN_END };
 
+const int STAGE_SIZE = GEN_END + 1;
+
+const char * const Stage_Name[STAGE_SIZE] = { "evasion", "trans", "tactical", "killer", "check", "pawn", "quiet", "bad", "end" };
+
+struct Stats { // per thread
+   int64 list;                  // move lists (nodes that reached the move loop)
+   int64 entered[STAGE_SIZE];   // stage reached
+   int64 generated[STAGE_SIZE]; // moves generated (and scored)
+   int64 yielded[STAGE_SIZE];   // moves returned by next()
+
+   void clear() {
+
+      list = 0;
+
+      for (int i = 0; i < STAGE_SIZE; i++) {
+         entered[i] = 0;
+         generated[i] = 0;
+         yielded[i] = 0;
+      }
+   }
+
+   void add(const Stats & st) {
+
+      list += st.list;
+
+      for (int i = 0; i < STAGE_SIZE; i++) {
+         entered[i] += st.entered[i];
+         generated[i] += st.generated[i];
+         yielded[i] += st.yielded[i];
+      }
+   }
+};
+
 class List {
 
 private:
@@ -3804,10 +4227,12 @@ private:
    const sort::Killer * p_killer;
    const sort::History * p_hist;
    int p_trans_move;
+   Stats * p_stats;
 
    const Inst * p_ip;
    Inst p_gen;
    Inst p_post;
+   bool p_select; // scored stage, pick best remaining move
 
    gen::List p_todo;
    gen::List p_done;
@@ -3820,13 +4245,15 @@ private:
 
       p_todo.clear();
       p_pos = 0;
+      p_select = false;
 
       switch (p_gen) { {
 
       } case GEN_EVASION: {
 
          gen::add_evasions(p_todo, p_board->turn(), *p_board, *p_attacks);
-         sort::sort_evasions(p_todo, p_trans_move);
+         sort::score_evasions(p_todo, p_trans_move);
+         p_select = true;
          break;
 
       } case GEN_TRANS: {
@@ -3845,7 +4272,8 @@ private:
 
          gen::add_captures(p_todo, p_board->turn(), *p_board);
          gen::add_promotions(p_todo, p_board->turn(), *p_board);
-         sort::sort_tacticals(p_todo);
+         sort::score_tacticals(p_todo);
+         p_select = true;
 
          p_candidate = true;
 
@@ -3889,7 +4317,8 @@ private:
       } case GEN_QUIET: {
 
          gen::add_quiets(p_todo, p_board->turn(), *p_board);
-         sort::sort_history(p_todo, *p_board, *p_hist);
+         sort::score_history(p_todo, *p_board, *p_hist);
+         p_select = true;
 
          p_candidate = false;
 
@@ -3905,6 +4334,8 @@ private:
 
       } case GEN_END: {
 
+         if (p_stats != NULL) p_stats->entered[GEN_END]++;
+
          return false;
 
       } default: {
@@ -3913,6 +4344,11 @@ private:
 
       } }
 
+      if (p_stats != NULL) {
+         p_stats->entered[p_gen]++;
+         p_stats->generated[p_gen] += p_todo.size();
+      }
+
       return true;
    }
 
@@ -4001,13 +4437,16 @@ private:
 
 public:
 
-   void init(int depth, board::Board & bd, const attack::Attacks & attacks, int trans_move, const sort::Killer & killer, const sort::History & history, bool use_fp = false) {
+   void init(int depth, board::Board & bd, const attack::Attacks & attacks, int trans_move, const sort::Killer & killer, const sort::History & history, bool use_fp = false, Stats * stats = NULL) {
 
       p_board = &bd;
       p_attacks = &attacks;
       p_killer = &killer;
       p_hist = &history;
       p_trans_move = trans_move;
+      p_stats = stats;
+
+      if (p_stats != NULL) p_stats->list++;
 
       if (false) {
       } else if (attacks.size != 0) { // in check
@@ -4028,6 +4467,7 @@ public:
 
       p_pos = 0;
       p_candidate = false;
+      p_select = false;
    }
 
    int next() {
@@ -4042,8 +4482,13 @@ public:
             if (!gen()) return move::NONE;
          }
 
-         int mv = p_todo.move(p_pos++);
-         if (post(mv)) return mv;
+         int mv = p_select ? p_todo.select(p_pos) : p_todo.move(p_pos);
+         p_pos++;
+
+         if (post(mv)) {
+            if (p_stats != NULL) p_stats->yielded[p_gen]++;
+            return mv;
+         }
       }
    }
 
@@ -4729,7 +5174,7 @@ void comp_attacks(Attack_Info & ai, const board::Board & bd) {
 
             int sq = bit::first(fs);
 
-            bit_t ts = attack::piece_attacks_from(pc, sq, bd);
+            bit_t ts = bd.has_attacks() ? bd.piece_attacks(sq) : attack::piece_attacks_from(pc, sq, bd);
             ai.piece_attacks[sq] = ts;
 
             ai.multiple_attacks[sd] |= ts & ai.all_attacks[sd];
@@ -5416,12 +5861,9 @@ namespace search {
 const int MAX_DEPTH = 100;
 const int MAX_PLY = 100;
 const int NODE_PERIOD = 1024;
+const int REPORT_PERIOD = 1; // ms
 
-const int MAX_THREADS = 16;
-
-class Abort : public std::exception { // SP fail-high exception
-
-};
+const int MAX_THREADS = 64;
 
 void update_current ();
 
@@ -5537,11 +5979,69 @@ Time p_time;
 Current current;
 Best best;
 
-class Search_Global : public util::Lockable {
+bool silent; // no info output and no input polling (bench)
+bool quit; // "quit" or end of input received during a search, the main loop exits once the reporter has been joined
 
-public:
+class Reporter : public util::Lockable { // UCI output is batched and flushed by the reporter thread
 
-   trans::Table trans;
+private:
+
+   std::string p_buffer;
+   std::atomic<bool> p_running;
+   std::thread p_thread;
+
+public:
+
+   Reporter() {
+      p_running = false;
+   }
+
+   bool running() const {
+      return p_running.load(std::memory_order_relaxed);
+   }
+
+   void post(const std::string & s) {
+
+      lock();
+      p_buffer += s;
+      unlock();
+
+      if (!running()) flush();
+   }
+
+   void flush() {
+
+      std::string s;
+
+      lock();
+      s.swap(p_buffer);
+      unlock();
+
+      if (s != "") std::cout << s << std::flush;
+   }
+
+   void start(void (*program)()) {
+      assert(!running());
+      p_running = true;
+      p_thread = std::thread(program);
+   }
+
+   void stop() {
+      assert(running());
+      p_running = false;
+      p_thread.join();
+      flush();
+   }
+
+};
+
+Reporter reporter;
+
+class Search_Global : public util::Lockable {
+
+public:
+
+   trans::Table trans;
    sort::History history;
 
 };
@@ -5592,7 +6092,10 @@ private:
    Search_Local * p_master;
    Split_Point * p_parent;
 
-   board::Board p_board;
+   int p_path[MAX_PLY]; // moves from the search root, instead of a full board copy
+   int p_path_size;
+   hash_t p_key;
+
    int p_depth;
    int p_old_alpha;
    int volatile p_alpha;
@@ -5609,6 +6112,8 @@ private:
    int volatile p_bm;
    PV p_pv;
 
+   int64 volatile p_cutoff_time; // ns, 0 = no cutoff (yet)
+
 public:
 
    void init_root(Search_Local & master) {
@@ -5622,6 +6127,8 @@ public:
 
       p_workers = 1;
       p_received = -1; // HACK
+
+      p_cutoff_time = 0;
    }
 
    void init(Search_Local & master, Split_Point & parent, const board::Board & bd, int depth, int old_alpha, int alpha, int beta, gen_sort::List & todo, const gen::List & done, int bs, int bm, const PV & pv) {
@@ -5635,7 +6142,10 @@ public:
       p_master = &master;
       p_parent = &parent;
 
-      p_board = bd;
+      assert(bd.ply() <= MAX_PLY);
+      p_path_size = bd.path(p_path);
+      p_key = bd.key();
+
       p_depth = depth;
       p_old_alpha = old_alpha;
       p_alpha = alpha;
@@ -5656,6 +6166,8 @@ public:
       p_bs = bs;
       p_bm = bm;
       p_pv = pv;
+
+      p_cutoff_time = 0;
    }
 
    void enter() {
@@ -5716,14 +6228,22 @@ public:
             p_bm = mv;
             p_alpha = sc;
          }
+
+         if (sc >= p_beta && p_cutoff_time == 0) {
+            p_cutoff_time = util::nanoseconds();
+         }
       }
 
       unlock();
    }
 
-   const board::Board & board() const { return p_board; }
+   void restore(board::Board & bd) const { // bd must come from the same search root
+      bd.set_path(p_path, p_path_size);
+      assert(bd.key() == p_key);
+   }
 
    Split_Point * parent() const { return p_parent; }
+   Search_Local * master() const { return p_master; }
 
    int  depth()     const { return p_depth; }
    int  alpha()     const { return p_alpha; }
@@ -5731,6 +6251,7 @@ public:
    int  old_alpha() const { return p_old_alpha; }
    int  bs()        const { return p_bs; }
    int  bm()        const { return p_bm; }
+   int64 cutoff_time() const { return p_cutoff_time; }
    bool solved()    const { return p_bs >= p_beta || p_received == p_todo.size(); }
    bool free()      const { return p_workers == 0; }
 
@@ -5758,12 +6279,21 @@ public:
 
    board::Board board;
    sort::Killer killer;
+   sort::History history; // used if engine.local_history
+   gen_sort::Stats gen_stats;
    pawn::Table pawn_table;
    eval::Table eval_table;
 
    int64 volatile node;
    int volatile max_ply;
 
+   int64 split_count; // as master
+   int64 split_time;  // ns, filling the split point
+   int64 join_count;  // as helper
+   int64 join_time;   // ns, rebuilding the split-point board
+   int64 abort_count; // split-point searches cut short
+   int64 abort_time;  // ns, from the cutoff until back in the idle loop
+
    Split_Point msp_stack[16];
    int msp_stack_size;
 
@@ -5852,44 +6382,48 @@ void update_current() {
 
 void write_pv(Best & best) {
 
-   sg.lock();
+   if (silent) return;
+
+   std::stringstream ss;
 
-   std::cout << "info";
-   std::cout << " depth " << best.depth;
-   std::cout << " seldepth " << current.max_ply;
-   std::cout << " nodes " << current.node;
-   std::cout << " time " << current.time;
+   ss << "info";
+   ss << " depth " << best.depth;
+   ss << " seldepth " << current.max_ply;
+   ss << " nodes " << current.node;
+   ss << " time " << current.time;
 
    if (score::is_mate(best.score)) {
-      std::cout << " score mate " << score::signed_mate(best.score);
+      ss << " score mate " << score::signed_mate(best.score);
    } else {
-      std::cout << " score cp " << best.score;
+      ss << " score cp " << best.score;
    }
-   if (best.flags == score::FLAGS_LOWER) std::cout << " lowerbound";
-   if (best.flags == score::FLAGS_UPPER) std::cout << " upperbound";
+   if (best.flags == score::FLAGS_LOWER) ss << " lowerbound";
+   if (best.flags == score::FLAGS_UPPER) ss << " upperbound";
 
-   std::cout << " pv " << best.pv.to_can();
-   std::cout << std::endl;
+   ss << " pv " << best.pv.to_can();
+   ss << "\n";
 
-   sg.unlock();
+   reporter.post(ss.str());
 }
 
 void write_info() {
 
-   sg.lock();
-
-   std::cout << "info";
-   std::cout << " depth " << current.depth;
-   std::cout << " seldepth " << current.max_ply;
-   std::cout << " currmove " << move::to_can(current.move);
-   std::cout << " currmovenumber " << current.pos + 1;
-   std::cout << " nodes " << current.node;
-   std::cout << " time " << current.time;
-   if (current.speed != 0) std::cout << " nps " << current.speed;
-   std::cout << " hashfull " << sg.trans.used();
-   std::cout << std::endl;
+   if (silent) return;
+
+   std::stringstream ss;
+
+   ss << "info";
+   ss << " depth " << current.depth;
+   ss << " seldepth " << current.max_ply;
+   ss << " currmove " << move::to_can(current.move);
+   ss << " currmovenumber " << current.pos + 1;
+   ss << " nodes " << current.node;
+   ss << " time " << current.time;
+   if (current.speed != 0) ss << " nps " << current.speed;
+   ss << " hashfull " << sg.trans.used();
+   ss << "\n";
 
-   sg.unlock();
+   reporter.post(ss.str());
 }
 
 void write_info_opt() {
@@ -5972,27 +6506,30 @@ void idle_loop(Search_Local & sl, Split_Point & wait_sp) {
          sl.wait();
       }
 
-      Split_Point & sp = *sl.todo_sp;
+      Split_Point * todo_sp = sl.todo_sp;
       sl.todo = true;
       sl.todo_sp = NULL;
 
       sl.unlock();
 
-      if (&sp == NULL) {
+      if (todo_sp == NULL) {
          break;
       }
 
+      Split_Point & sp = *todo_sp;
+
       // sp.enter();
 
       sl_push(sl, sp);
+      search_split_point(sl, sp);
+      sl_pop(sl);
 
-      try {
-         search_split_point(sl, sp);
-      } catch (const Abort & /* abort */) {
-         // no-op
-      }
+      int64 cutoff = sp.cutoff_time();
 
-      sl_pop(sl);
+      if (cutoff != 0) { // returned early because of a cutoff
+         sl.abort_count++;
+         sl.abort_time += util::nanoseconds() - cutoff;
+      }
 
       sp.leave();
    }
@@ -6039,6 +6576,47 @@ void init_sg() {
    sg.history.clear();
 }
 
+sort::History & history(Search_Local & sl) {
+   return engine::engine.local_history ? sl.history : sg.history;
+}
+
+void merge_history() { // between iterations, helpers are idle
+
+   if (!engine::engine.local_history || engine::engine.threads == 1) return;
+
+   sort::History * table[MAX_THREADS];
+
+   for (int id = 0; id < engine::engine.threads; id++) {
+      table[id] = &p_sl[id].history;
+   }
+
+   sort::History::merge(table, engine::engine.threads);
+}
+
+void gen_stats(gen_sort::Stats & st) { // last search, all threads
+
+   st.clear();
+
+   for (int id = 0; id < engine::engine.threads; id++) {
+      st.add(p_sl[id].gen_stats);
+   }
+}
+
+void smp_stats(int64 & splits, int64 & split_time, int64 & joins, int64 & join_time, int64 & aborts, int64 & abort_time) { // last search, all threads
+
+   splits = split_time = joins = join_time = aborts = abort_time = 0;
+
+   for (int id = 0; id < engine::engine.threads; id++) {
+      const Search_Local & sl = p_sl[id];
+      splits += sl.split_count;
+      split_time += sl.split_time;
+      joins += sl.join_count;
+      join_time += sl.join_time;
+      aborts += sl.abort_count;
+      abort_time += sl.abort_time;
+   }
+}
+
 void search_root(Search_Local & sl, gen::List & ml, int depth, int alpha, int beta) {
 
    assert(depth > 0 && depth < MAX_DEPTH);
@@ -6104,6 +6682,8 @@ void search_root(Search_Local & sl, gen::List & ml, int depth, int alpha, int be
 
       move_end();
 
+      if (sl_stop(sl)) return; // aborted, sc is meaningless
+
       searched_size++;
 
       if (sc > bs) {
@@ -6154,6 +6734,8 @@ int search(Search_Local & sl, int depth, int alpha, int beta, PV & pv) {
 
    pv.clear();
 
+   if (sl_stop(sl)) return 0; // aborted, e.g. a PVS/LMR re-search after a split point was solved
+
    bool pv_node = depth > 0 && beta != alpha + 1;
 
    // mate-distance pruning
@@ -6236,6 +6818,8 @@ int search(Search_Local & sl, int depth, int alpha, int beta, PV & pv) {
 
       bd.undo_null(); // TODO: use sl?
 
+      if (sl_stop(sl)) return 0; // aborted, the caller ignores the result
+
       if (sc >= beta) {
 
          if (use_trans) {
@@ -6294,6 +6878,8 @@ int search(Search_Local & sl, int depth, int alpha, int beta, PV & pv) {
       PV npv;
       int sc = search(sl, depth - 2, alpha, beta, npv); // to keep PV-node property
 
+      if (sl_stop(sl)) return 0;
+
       if (sc > alpha && npv.size() != 0) {
          trans_move = npv.move(0);
       }
@@ -6302,7 +6888,7 @@ int search(Search_Local & sl, int depth, int alpha, int beta, PV & pv) {
    // move loop
 
    gen_sort::List ml;
-   ml.init(depth, bd, attacks, trans_move, sl.killer, sg.history, use_fp);
+   ml.init(depth, bd, attacks, trans_move, sl.killer, history(sl), use_fp, &sl.gen_stats);
 
    gen::List searched;
 
@@ -6348,6 +6934,8 @@ int search(Search_Local & sl, int depth, int alpha, int beta, PV & pv) {
 
       undo(sl);
 
+      if (sl_stop(sl)) return 0;
+
       searched.add(mv);
 
       if (sc > bs) {
@@ -6368,7 +6956,7 @@ int search(Search_Local & sl, int depth, int alpha, int beta, PV & pv) {
 
                if (depth > 0 && !in_check && !move::is_tactical(mv)) {
                   sl.killer.add(mv, bd.ply());
-                  sg.history.add(mv, searched, bd);
+                  history(sl).add(mv, searched, bd);
                }
 
                return sc;
@@ -6405,7 +6993,10 @@ int split(Search_Local & master, int depth, int old_alpha, int alpha, int beta,
 
    Split_Point & parent = sl_top(master);
 
+   int64 start = util::nanoseconds();
    sp.init(master, parent, master.board, depth, old_alpha, alpha, beta, todo, done, bs, bm, pv);
+   master.split_count++;
+   master.split_time += util::nanoseconds() - start;
 
    for (int id = 0; id < engine::engine.threads; id++) {
 
@@ -6418,11 +7009,7 @@ int split(Search_Local & master, int depth, int old_alpha, int alpha, int beta,
 
    smp.unlock();
 
-   try {
-      master_split_point(master, sp);
-   } catch (const Abort & /* abort */) {
-      // no-op
-   }
+   master_split_point(master, sp);
 
    assert(master.msp_stack_size > 0);
    assert(&master.msp_stack[master.msp_stack_size - 1] == &sp);
@@ -6436,22 +7023,18 @@ void master_split_point(Search_Local & sl, Split_Point & sp) {
    sp.enter();
 
    sl_push(sl, sp);
-
-   try {
-      search_split_point(sl, sp);
-   } catch (const Abort & /* abort */) {
-      // no-op
-   }
-
+   search_split_point(sl, sp);
    sl_pop(sl);
 
    sp.leave();
 
    idle_loop(sl, sp);
-   sl.board = sp.board();
+   sp.restore(sl.board);
 
    assert(sp.free());
 
+   if (sl_stop(sl)) return; // a parent was solved, sp may be incomplete
+
    // update move-ordering tables
 
    board::Board & bd = sl.board;
@@ -6466,7 +7049,7 @@ void master_split_point(Search_Local & sl, Split_Point & sp) {
 
    if (bs >= sp.beta() && depth > 0 && !attack::is_in_check(bd) && !move::is_tactical(bm)) {
       sl.killer.add(bm, ply);
-      sg.history.add(bm, sp.searched(), bd);
+      history(sl).add(bm, sp.searched(), bd);
    }
 
    if (depth >= 0) {
@@ -6478,7 +7061,15 @@ void master_split_point(Search_Local & sl, Split_Point & sp) {
 void search_split_point(Search_Local & sl, Split_Point & sp) {
 
    board::Board & bd = sl.board;
-   bd = sp.board();
+
+   if (&sl != sp.master()) {
+      int64 start = util::nanoseconds();
+      sp.restore(bd);
+      sl.join_count++;
+      sl.join_time += util::nanoseconds() - start;
+   } else {
+      sp.restore(bd); // no-op for the master
+   }
 
    int depth = sp.depth();
    int old_alpha = sp.old_alpha();
@@ -6530,6 +7121,8 @@ void search_split_point(Search_Local & sl, Split_Point & sp) {
 
       undo(sl);
 
+      if (sl_stop(sl)) break; // split point (or a parent) is solved
+
       sp.update(mv, sc, npv);
    }
 }
@@ -6556,7 +7149,7 @@ int qs_static(Search_Local & sl, int beta, int gain) { // for static NMP
    attack::init_attacks(attacks, bd);
 
    gen_sort::List ml;
-   ml.init(-1, bd, attacks, move::NONE, sl.killer, sg.history, false); // QS move generator
+   ml.init(-1, bd, attacks, move::NONE, sl.killer, history(sl), false, &sl.gen_stats); // QS move generator
 
    bit_t done = 0;
 
@@ -6588,60 +7181,79 @@ int qs_static(Search_Local & sl, int beta, int gain) { // for static NMP
    return bs;
 }
 
-void inc_node(Search_Local & sl) {
+void inc_node(Search_Local & sl) { // time limits and input are checked by the reporter thread
 
    sl.node++;
 
-   if (sl.node % NODE_PERIOD == 0) {
+   if (p_time.node_limited && sl.node % NODE_PERIOD == 0) { // node limits stay on the search thread, to be reproducible
+
+      int64 node = 0;
 
-      bool abort = false;
+      for (int id = 0; id < engine::engine.threads; id++) {
+         node += p_sl[id].node;
+      }
 
-      update_current();
+      if (node >= p_time.node_limit) sg_abort();
+   }
+}
 
-      if (poll()) abort = true;
+bool check_limits() { // reporter thread
 
-      if (p_time.node_limited && current.node >= p_time.node_limit) {
-         abort = true;
-      }
+   bool abort = false;
 
-      if (p_time.time_limited && current.time >= p_time.time_limit) {
-         abort = true;
-      }
+   update_current();
 
-      if (p_time.smart && current.depth > 1 && current.time >= p_time.limit_0) {
-         if (current.pos == 0 || current.time >= p_time.limit_1) {
-            if (!(p_time.drop || current.fail_high) || current.time >= p_time.limit_2) {
-               if (p_time.ponder) {
-                  p_time.flag = true;
-               } else {
-                  abort = true;
-               }
+   if (!silent && poll()) abort = true; // bench leaves queued commands for the main loop
+
+   if (p_time.time_limited && current.time >= p_time.time_limit) {
+      abort = true;
+   }
+
+   if (p_time.smart && current.depth > 1 && current.time >= p_time.limit_0) {
+      if (current.pos == 0 || current.time >= p_time.limit_1) {
+         if (!(p_time.drop || current.fail_high) || current.time >= p_time.limit_2) {
+            if (p_time.ponder) {
+               p_time.flag = true;
+            } else {
+               abort = true;
             }
          }
       }
+   }
 
-      if (p_time.smart && current.depth > 1 && current.size == 1 && current.time >= p_time.limit_0 / 8) {
-         if (p_time.ponder) {
-            p_time.flag = true;
-         } else {
-            abort = true;
-         }
+   if (p_time.smart && current.depth > 1 && current.size == 1 && current.time >= p_time.limit_0 / 8) {
+      if (p_time.ponder) {
+         p_time.flag = true;
+      } else {
+         abort = true;
       }
-
-      if (abort) sg_abort();
    }
 
-   if (sl_stop(sl)) throw Abort();
+   return abort;
 }
 
-bool poll() {
+void reporter_program() {
 
-   write_info_opt();
+   bool aborted = false;
+
+   while (reporter.running()) {
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(REPORT_PERIOD));
 
-   sg.lock();
+      if (!aborted && check_limits()) {
+         sg_abort();
+         aborted = true;
+      }
+
+      reporter.flush();
+   }
+}
+
+bool poll() { // reporter thread
+
+   write_info_opt();
 
    if (!input::input.has_input()) {
-      sg.unlock();
       return false;
    }
 
@@ -6649,13 +7261,12 @@ bool poll() {
    bool eof = !input::input.get_line(line);
    if (engine::engine.log) util::log(line);
 
-   sg.unlock();
-
    if (false) {
    } else if (eof) {
-      std::exit(EXIT_SUCCESS);
+      quit = true;
+      return true;
    } else if (line == "isready") {
-      std::cout << "readyok" << std::endl;
+      reporter.post("readyok\n");
       return false;
    } else if (line == "stop") {
       uci::infinite = false;
@@ -6665,7 +7276,8 @@ bool poll() {
       p_time.ponder = false;
       return p_time.flag;
    } else if (line == "quit") {
-      std::exit(EXIT_SUCCESS);
+      quit = true;
+      return true;
    }
 
    return false;
@@ -6759,6 +7371,17 @@ void sl_init_early(Search_Local & sl, int id) {
 
    sl.msp_stack_size = 0;
    sl.ssp_stack_size = 0;
+
+   sl.split_count = 0;
+   sl.split_time = 0;
+   sl.join_count = 0;
+   sl.join_time = 0;
+   sl.abort_count = 0;
+   sl.abort_time = 0;
+
+   sl.gen_stats.clear();
+
+   sl.history.clear();
 }
 
 void sl_init_late(Search_Local & sl) {
@@ -6843,6 +7466,10 @@ void search_asp(gen::List & ml, int depth) {
 
          search_root(sl, ml, depth, a, b);
 
+         if (sl_stop(sl)) {
+            return;
+         }
+
          if (best.score > a && best.score < b) {
             return;
          } else if (score::is_mate(best.score)) {
@@ -6884,8 +7511,15 @@ void search_id(const board::Board & bd) {
 
       depth_start(depth);
       search_asp(ml, depth);
+
+      if (sl_stop(sl)) {
+         break;
+      }
+
       depth_end();
 
+      merge_history();
+
       // p_time.drop = (best.score <= p_time.last_score - 50); // moved to update_best()
       p_time.last_score = best.score;
 
@@ -6933,6 +7567,7 @@ void search_go(const board::Board & bd) {
 
    for (int id = 0; id < engine::engine.threads; id++) {
       sl_init_early(p_sl[id], id);
+      if (id != 0) sl_set_root(p_sl[id], bd); // split points only carry the path from the root
    }
 
    root_sp.init_root(p_sl[0]);
@@ -6943,11 +7578,9 @@ void search_go(const board::Board & bd) {
 
    sl_init_late(p_sl[0]);
 
-   try {
-      search_id(bd);
-   } catch (const Abort & /* abort */) {
-      // no-op
-   }
+   reporter.start(reporter_program);
+
+   search_id(bd);
 
    sg_abort();
 
@@ -6956,6 +7589,8 @@ void search_go(const board::Board & bd) {
    }
 
    search_end();
+
+   reporter.stop();
 }
 
 void search_dumb(const board::Board & bd) {
@@ -6996,12 +7631,409 @@ void search_smart(const board::Board & bd, int moves, int64 time, int64 inc) {
 }
 
 void init() {
+   silent = false;
    sg.trans.set_size(engine::engine.hash);
+   sg.trans.set_large_pages(engine::engine.large_pages);
    sg.trans.alloc();
 }
 
 }
 
+namespace bench {
+
+const char * const fens[] = {
+   "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -",
+   "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+   "2kr2nr/pp1n1ppp/2p1p3/q7/1b1P1B2/P1N2Q1P/1PP1BPP1/R3K2R w KQ -",
+   "r5n1/p2q3k/4b2p/3pB3/2PP1QpP/8/PP4P1/5RK1 w - -",
+   "2kr1b1r/ppp3p1/5nbp/4B3/2P5/3P2Nq/PP2BP2/R2Q1RK1 b - -",
+   "r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ -",
+   "r1b1rbk1/1p3p1p/p2ppBp1/4P3/q4P1Q/P2B4/1PP3PP/1R3R1K w - -",
+   "8/1P2Qr1k/2b3pp/2pBp3/5q2/1N2R3/6KP/8 w - -",
+   "3r4/8/8/P7/1P6/1K3kpR/8/8 b - -",
+   "8/8/8/P7/1n6/1P4k1/3K2p1/6B1 w - -",
+   "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",
+   "6k1/5p2/6p1/8/7p/8/6PP/6K1 b - -",
+};
+
+const int SIZE = sizeof(fens) / sizeof(fens[0]);
+
+struct Result {
+   int64 node;
+   int64 time;
+   int hashfull;
+   int move;
+   int score;
+   int64 splits;
+   int64 split_time; // ns
+   int64 joins;
+   int64 join_time;  // ns
+   int64 aborts;
+   int64 abort_time; // ns
+};
+
+Result run_position(const std::string & fen, int depth) { // fixed-depth search from an empty hash table
+
+   board::Board bd;
+   bd.init_fen(fen);
+
+   search::sg.trans.clear();
+   search::new_search();
+   search::set_depth_limit(depth);
+
+   search::silent = true;
+   search::search_dumb(bd);
+   search::silent = false;
+
+   Result res;
+
+   res.node = search::current.node;
+   res.time = search::current.time;
+   res.hashfull = search::sg.trans.used();
+   res.move = search::best.move;
+   res.score = search::best.score;
+
+   search::smp_stats(res.splits, res.split_time, res.joins, res.join_time, res.aborts, res.abort_time);
+
+   return res;
+}
+
+Result run(const std::vector<std::string> & fens, int depth, std::vector<Result> * results = NULL) {
+
+   Result res = { 0, 0, 0, move::NONE, 0, 0, 0, 0, 0, 0, 0 };
+
+   for (int i = 0; i < int(fens.size()); i++) {
+
+      Result r = run_position(fens[i], depth);
+      if (results != NULL) results->push_back(r);
+
+      res.node += r.node;
+      res.time += r.time;
+      res.hashfull += r.hashfull;
+      res.splits += r.splits;
+      res.split_time += r.split_time;
+      res.joins += r.joins;
+      res.join_time += r.join_time;
+      res.aborts += r.aborts;
+      res.abort_time += r.abort_time;
+   }
+
+   if (fens.size() != 0) res.hashfull /= int(fens.size());
+
+   return res;
+}
+
+Result run(int depth) {
+   return run(std::vector<std::string>(fens, fens + SIZE), depth);
+}
+
+bool load(std::vector<std::string> & list, const std::string & file_name) { // FEN or EPD, one position per line
+
+   std::ifstream file(file_name.c_str());
+   if (!file) return false;
+
+   std::string line;
+
+   while (std::getline(file, line)) {
+
+      std::stringstream ss(line);
+      std::string fen;
+      std::string field;
+
+      for (int i = 0; i < 4 && ss >> field; i++) { // skip move counters and EPD operations
+         if (i != 0) fen += " ";
+         fen += field;
+      }
+
+      if (fen != "" && fen[0] != '#') list.push_back(fen);
+   }
+
+   return true;
+}
+
+void bench(int depth, int threads, const std::string & file_name) { // speed signature, JSON output
+
+   std::vector<std::string> list;
+
+   if (file_name == "") {
+      list.assign(fens, fens + SIZE);
+   } else if (!load(list, file_name)) {
+      std::cout << "{ \"error\": \"can't open " << file_name << "\" }" << std::endl;
+      return;
+   }
+
+   int old_threads = engine::engine.threads;
+   engine::engine.threads = threads;
+
+   std::vector<Result> results;
+   Result res = run(list, depth, &results);
+
+   engine::engine.threads = old_threads;
+
+   std::cout << "{" << std::endl;
+   std::cout << "  \"engine\": \"Senpai 1.0\"," << std::endl;
+   std::cout << "  \"depth\": " << depth << "," << std::endl;
+   std::cout << "  \"threads\": " << threads << "," << std::endl;
+   std::cout << "  \"hash\": " << engine::engine.hash << "," << std::endl;
+   std::cout << "  \"positions\": [" << std::endl;
+
+   for (int i = 0; i < int(list.size()); i++) {
+
+      const Result & r = results[i];
+
+      std::cout << "    { \"fen\": \"" << list[i] << "\""
+                << ", \"nodes\": " << r.node
+                << ", \"time\": " << r.time
+                << ", \"bestmove\": \"" << move::to_can(r.move) << "\""
+                << ", \"score\": " << r.score
+                << " }" << (i + 1 < int(list.size()) ? "," : "") << std::endl;
+   }
+
+   std::cout << "  ]," << std::endl;
+   std::cout << "  \"nodes\": " << res.node << "," << std::endl;
+   std::cout << "  \"time\": " << res.time << "," << std::endl;
+   std::cout << "  \"nps\": " << res.node * 1000 / std::max(res.time, I64(1)) << std::endl;
+   std::cout << "}" << std::endl;
+}
+
+// perft
+
+int64 perft(board::Board & bd, int depth) {
+
+   if (depth == 0) return 1;
+
+   gen::List ml;
+   gen::gen_moves_debug(ml, bd); // pseudo-legal
+
+   int64 node = 0;
+
+   for (int pos = 0; pos < ml.size(); pos++) {
+
+      int mv = ml.move(pos);
+
+      bd.move(mv);
+      if (attack::is_legal(bd)) node += perft(bd, depth - 1);
+      bd.undo();
+   }
+
+   return node;
+}
+
+class Perft_Work : public util::Lockable { // root moves shared by the perft threads
+
+public:
+
+   board::Board board;
+   gen::List ml;
+   int depth;
+   int next;
+   std::vector<int64> node;
+
+   int get() {
+
+      lock();
+      int pos = (next < ml.size()) ? next++ : -1;
+      unlock();
+
+      return pos;
+   }
+
+};
+
+void perft_program(Perft_Work * work) {
+
+   board::Board bd;
+   bd = work->board;
+
+   for (int pos = work->get(); pos >= 0; pos = work->get()) {
+      bd.move(work->ml.move(pos));
+      work->node[pos] = perft(bd, work->depth - 1);
+      bd.undo();
+   }
+}
+
+void perft_root(const board::Board & bd, int depth, int threads, bool divide) {
+
+   assert(depth > 0);
+   assert(threads > 0);
+
+   Perft_Work work;
+
+   work.board = bd;
+   gen::gen_legals(work.ml, work.board);
+   work.depth = depth;
+   work.next = 0;
+   work.node.assign(work.ml.size(), 0);
+
+   util::Timer timer;
+   timer.start();
+
+   std::vector<std::thread> pool;
+
+   for (int id = 1; id < threads; id++) {
+      pool.push_back(std::thread(perft_program, &work));
+   }
+
+   perft_program(&work);
+
+   for (int id = 0; id < int(pool.size()); id++) {
+      pool[id].join();
+   }
+
+   timer.stop();
+
+   int64 node = 0;
+
+   for (int pos = 0; pos < work.ml.size(); pos++) {
+      if (divide) std::cout << move::to_can(work.ml.move(pos)) << " " << work.node[pos] << std::endl;
+      node += work.node[pos];
+   }
+
+   int time = timer.elapsed();
+
+   if (divide) std::cout << "moves " << work.ml.size() << std::endl;
+   std::cout << "perft " << depth << " nodes " << node << " time " << time << " nps " << node * 1000 / std::max(time, 1) << std::endl;
+}
+
+void gen(int depth) { // move-generation stage counters over the bench positions, single thread
+
+   int old_threads = engine::engine.threads;
+   engine::engine.threads = 1;
+
+   gen_sort::Stats st;
+   st.clear();
+
+   int64 node = 0;
+
+   for (int i = 0; i < SIZE; i++) {
+
+      Result r = run_position(fens[i], depth);
+      node += r.node;
+
+      gen_sort::Stats pos_st;
+      search::gen_stats(pos_st);
+      st.add(pos_st);
+   }
+
+   engine::engine.threads = old_threads;
+
+   std::cout << "nodes " << node << " move lists " << st.list << std::endl;
+   std::cout << "stage     entered  %lists   generated     yielded  not-yielded" << std::endl;
+
+   for (int i = 0; i < gen_sort::STAGE_SIZE; i++) {
+
+      if (st.entered[i] == 0) continue;
+
+      std::cout << std::left << std::setw(8) << gen_sort::Stage_Name[i] << std::right
+                << std::setw(10) << st.entered[i]
+                << std::setw(8) << std::fixed << std::setprecision(1) << double(st.entered[i]) * 100.0 / double(std::max(st.list, I64(1)))
+                << std::setw(12) << st.generated[i]
+                << std::setw(12) << st.yielded[i]
+                << std::setw(13) << st.generated[i] - st.yielded[i]
+                << std::endl;
+   }
+
+   std::cout.unsetf(std::ios::floatfield);
+   std::cout << std::setprecision(6);
+}
+
+void attacks(int depth, int perft_depth) { // incremental attack tables off, on and self-checked
+
+   static const char * const mode_name[] = { "off", "on", "check" };
+
+   int old_threads = engine::engine.threads;
+   int old_mode = board::attack_mode;
+
+   engine::engine.threads = 1;
+
+   for (int mode = board::ATTACK_OFF; mode <= board::ATTACK_CHECK; mode++) {
+
+      board::attack_mode = mode;
+
+      Result res = run(depth);
+
+      board::Board bd;
+      bd.init_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -");
+
+      util::Timer timer;
+      timer.start();
+      int64 node = perft(bd, perft_depth);
+      timer.stop();
+
+      int time = timer.elapsed();
+
+      std::cout << "attack tables " << std::left << std::setw(6) << mode_name[mode] << std::right
+                << " search nodes " << res.node << " time " << res.time << " nps " << res.node * 1000 / std::max(res.time, I64(1))
+                << " | perft " << perft_depth << " nodes " << node << " time " << time << " nps " << node * 1000 / std::max(time, 1)
+                << std::endl;
+   }
+
+   board::attack_mode = old_mode;
+   engine::engine.threads = old_threads;
+}
+
+void scaling(int depth, const std::vector<int> & threads) { // NPS and time-to-depth for each thread count
+
+   int old_threads = engine::engine.threads;
+
+   int64 base_time = 0;
+
+   for (int i = 0; i < int(threads.size()); i++) {
+
+      engine::engine.threads = threads[i];
+
+      Result res = run(depth);
+      if (i == 0) base_time = res.time;
+
+      int64 nps = res.node * 1000 / std::max(res.time, I64(1));
+
+      std::cout << "threads " << threads[i]
+                << " depth " << depth
+                << " nodes " << res.node
+                << " time " << res.time
+                << " nps " << nps
+                << " nps/thread " << nps / threads[i]
+                << " ttd-speedup " << double(base_time) / double(std::max(res.time, I64(1)))
+                << " hashfull " << res.hashfull
+                << " splits/s " << res.splits * 1000 / std::max(res.time, I64(1))
+                << " split-ns " << res.split_time / std::max(res.splits, I64(1))
+                << " join-ns " << res.join_time / std::max(res.joins, I64(1))
+                << " aborts/s " << res.aborts * 1000 / std::max(res.time, I64(1))
+                << " abort-ns " << res.abort_time / std::max(res.aborts, I64(1))
+                << std::endl;
+   }
+
+   engine::engine.threads = old_threads;
+}
+
+void smp(int depth, const std::vector<int> & threads) { // with and without huge pages
+
+   std::cout << "split point " << sizeof(search::Split_Point) << " bytes, thread " << sizeof(search::Search_Local) << " bytes" << std::endl;
+
+   for (int lp = 1; lp >= 0; lp--) {
+      search::sg.trans.set_large_pages(lp != 0);
+      std::cout << "large pages " << (lp != 0 ? "on" : "off") << " (obtained " << (search::sg.trans.large_pages() ? "yes" : "no") << ")" << std::endl;
+      scaling(depth, threads);
+   }
+
+   search::sg.trans.set_large_pages(engine::engine.large_pages);
+}
+
+void history(int depth, const std::vector<int> & threads) { // shared vs thread-local history tables
+
+   bool old_local = engine::engine.local_history;
+
+   for (int local = 0; local < 2; local++) {
+      engine::engine.local_history = local != 0;
+      std::cout << (local != 0 ? "thread-local history, merged every iteration" : "shared history, relaxed atomics") << std::endl;
+      scaling(depth, threads);
+   }
+
+   engine::engine.local_history = old_local;
+}
+
+}
+
 namespace uci {
 
 board::Board bd;
@@ -7116,8 +8148,11 @@ void command(Scanner & scan) {
 
       std::cout << "option name Hash type spin default " << engine::engine.hash << " min 16 max 16384" << std::endl;
       std::cout << "option name Ponder type check default " << engine::engine.ponder << std::endl;
-      std::cout << "option name Threads type spin default " << engine::engine.threads << " min 1 max 16" << std::endl;
+      std::cout << "option name Threads type spin default " << engine::engine.threads << " min 1 max " << search::MAX_THREADS << std::endl;
       std::cout << "option name Log File type check default " << engine::engine.log << std::endl;
+      std::cout << "option name Large Pages type check default " << engine::engine.large_pages << std::endl;
+      std::cout << "option name Local History type check default " << engine::engine.local_history << std::endl;
+      std::cout << "option name Attack Tables type combo default Off var Off var On var Check" << std::endl;
 
       std::cout << "uciok" << std::endl;
 
@@ -7152,9 +8187,23 @@ void command(Scanner & scan) {
       } else if (util::string_case_equal(name, "Ponder")) {
          engine::engine.ponder = util::to_bool(value);
       } else if (util::string_case_equal(name, "Threads") || util::string_case_equal(name, "Cores")) {
-         engine::engine.threads = int(util::to_int(value));
+         engine::engine.threads = std::max(1, std::min(int(util::to_int(value)), search::MAX_THREADS));
       } else if (util::string_case_equal(name, "Log File")) {
          engine::engine.log = util::to_bool(value);
+      } else if (util::string_case_equal(name, "Large Pages")) {
+         engine::engine.large_pages = util::to_bool(value);
+         search::sg.trans.set_large_pages(engine::engine.large_pages);
+      } else if (util::string_case_equal(name, "Local History")) {
+         engine::engine.local_history = util::to_bool(value);
+      } else if (util::string_case_equal(name, "Attack Tables")) { // takes effect at the next "position"
+         if (false) {
+         } else if (util::string_case_equal(value, "On")) {
+            board::attack_mode = board::ATTACK_ON;
+         } else if (util::string_case_equal(value, "Check")) {
+            board::attack_mode = board::ATTACK_CHECK;
+         } else {
+            board::attack_mode = board::ATTACK_OFF;
+         }
       }
 
    } else if (command == "ucinewgame") {
@@ -7303,6 +8352,68 @@ void command(Scanner & scan) {
    } else if (command == "quit") {
 
       std::exit(EXIT_SUCCESS);
+
+   } else if (command == "bench") { // bench [depth [threads [file]]]
+
+      std::string arg = scan.get_word();
+      int depth = (arg != "") ? int(util::to_int(arg)) : 12;
+
+      arg = scan.get_word();
+      int threads = (arg != "") ? int(util::to_int(arg)) : 1;
+
+      std::string file_name = scan.get_word();
+
+      bench::bench(std::max(1, std::min(depth, search::MAX_DEPTH - 1)), std::max(1, std::min(threads, search::MAX_THREADS)), file_name);
+
+   } else if (command == "perft" || command == "divide") { // perft|divide depth [threads], current position
+
+      std::string arg = scan.get_word();
+      int depth = (arg != "") ? int(util::to_int(arg)) : 1;
+
+      arg = scan.get_word();
+      int threads = (arg != "") ? int(util::to_int(arg)) : engine::engine.threads;
+
+      bench::perft_root(bd, std::max(1, std::min(depth, search::MAX_PLY - 1)), std::max(1, threads), command == "divide");
+
+   } else if (command == "genstats") { // genstats [depth]
+
+      std::string arg = scan.get_word();
+      int depth = (arg != "") ? int(util::to_int(arg)) : 12;
+
+      bench::gen(std::max(1, std::min(depth, search::MAX_DEPTH - 1)));
+
+   } else if (command == "attackbench") { // attackbench [depth [perft-depth]]
+
+      std::string arg = scan.get_word();
+      int depth = (arg != "") ? int(util::to_int(arg)) : 12;
+
+      arg = scan.get_word();
+      int perft_depth = (arg != "") ? int(util::to_int(arg)) : 4;
+
+      bench::attacks(std::max(1, std::min(depth, search::MAX_DEPTH - 1)), std::max(1, std::min(perft_depth, search::MAX_PLY - 1)));
+
+   } else if (command == "smpbench" || command == "histbench") { // smpbench|histbench [depth [threads ...]]
+
+      std::string arg = scan.get_word();
+      int depth = (arg != "") ? int(util::to_int(arg)) : 12;
+
+      std::vector<int> threads;
+
+      while ((arg = scan.get_word()) != "") {
+         threads.push_back(std::max(1, std::min(int(util::to_int(arg)), search::MAX_THREADS)));
+      }
+
+      if (threads.empty()) {
+         for (int n = 1; n <= search::MAX_THREADS; n *= 2) threads.push_back(n);
+      }
+
+      depth = std::max(1, std::min(depth, search::MAX_DEPTH - 1));
+
+      if (command == "smpbench") {
+         bench::smp(depth, threads);
+      } else {
+         bench::history(depth, threads);
+      }
    }
 }
 
@@ -7326,7 +8437,7 @@ void loop() {
 
    std::string line;
 
-   while (input::input.get_line(line)) {
+   while (!search::quit && input::input.get_line(line)) {
       uci::line(line);
    }
 }